@@ -0,0 +1,27 @@
+/*
+scoring.py:
+
+import time
+
+def score(a, b):
+  time.sleep(0.1)
+  return a * b
+*/
+
+PySession session;
+
+// Queue the call - returns immediately
+PyFuture *future = session.callFunctionAsync("scoring","score",session.buildPyValue("(ii)",6,7));
+
+// Do other work while the interpreter thread runs score
+...
+
+// value() waits for the call to complete
+if (future->ok())
+  std::cout << future->value().valueAsLong() << std::endl;
+else
+  std::cout << future->error().exceptionValue() << std::endl;
+
+// See whether calls are queueing up
+PyAsyncStats stats = session.asyncStats();
+std::cout << stats.depth << " calls waiting, average wait " << stats.totalWait/stats.queued << "s" << std::endl;
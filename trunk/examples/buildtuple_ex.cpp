@@ -0,0 +1,34 @@
+/*
+scoring.py:
+
+def score(weight, name, factor):
+  return weight * factor + len(name)
+*/
+
+PySession session;
+session.importModule("scoring");
+
+// The argument types replace the format, a wrong type does not compile
+clock_t start = clock();
+for (int i=0;i<100000;i++) {
+  PyValue args = pyTuple(12L,std::string("abc"),3.5);
+}
+std::cout << "pyTuple: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+start = clock();
+for (int i=0;i<100000;i++) {
+  session.buildPyValue("(lsd)",12L,"abc",3.5);
+  if (i%1000 == 999)
+    session.emptyResultBuffer();
+}
+std::cout << "buildPyValue: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+// Nested tuples, dicts and standard containers
+std::vector<long> ids;
+ids.push_back(1);
+ids.push_back(2);
+PyValue args = pyTuple(pyTuple(1,2),pyDict("abc",123,"def",456),ids);
+std::cout << args.str() << std::endl;
+
+PyValue scoreArgs = pyTuple(12L,"abc",3.5);
+std::cout << session.callFunction("scoring","score",&scoreArgs)->valueAsDouble() << std::endl;
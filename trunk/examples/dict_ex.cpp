@@ -0,0 +1,30 @@
+/*
+words.py:
+
+def counts(n):
+  return dict(('word%d' % i, i) for i in range(n))
+*/
+
+PySession session;
+session.importModule("words");
+
+PyValue *result = session.callFunction("words","counts",session.buildPyValue("(i)",200000));
+const PyDict &counts = result->valueAsDict();
+
+// Lookups hash the key once and probe a table, without comparing against other keys
+clock_t start = clock();
+long sum = 0;
+char word[32];
+for (int i=0;i<200000;i++) {
+  sprintf(word,"word%d",i);
+  sum += counts.value(word).valueAsLong();	// hashes the characters, no PyValue is built
+}
+std::cout << "lookups: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+// A PyKey is hashed once, for reading the same field of many dicts
+PyKey key("word42");
+sum += counts.value(key).valueAsLong();
+
+// Entries are iterated in the order python returned them
+for (PyDict::const_iterator it_val = counts.begin(); it_val != counts.end(); ++it_val)
+  sum += it_val->value.valueAsLong();
@@ -0,0 +1,43 @@
+/*
+scoring.py:
+
+def score(a, b):
+  return a * b
+*/
+
+PySession session(false);
+
+session.importModule("scoring");
+
+// The arguments are kept out of the result buffer, which is emptied while calling
+PyTuple pair;
+pair.addValue(PyValue(6L));
+pair.addValue(PyValue(7L));
+PyValue args(pair);
+const int calls = 1000000;
+
+// Resolve scoring.score once
+PyFunctionHandle *score = session.resolveFunction("scoring","score");
+if (!score)
+  return;
+
+// Call by name - module and function are looked up on every call
+clock_t start = clock();
+for (int i=0;i<calls;i++) {
+  session.callFunction("scoring","score",&args);
+  if (i%10000==0)
+    session.emptyResultBuffer();
+}
+double byName = double(clock()-start)/CLOCKS_PER_SEC;
+
+// Call through the handle - straight to the function
+start = clock();
+for (int i=0;i<calls;i++) {
+  score->call(&args);
+  if (i%10000==0)
+    session.emptyResultBuffer();
+}
+double byHandle = double(clock()-start)/CLOCKS_PER_SEC;
+
+std::cout << "callFunction:   " << byName << "s" << std::endl;
+std::cout << "resolved handle: " << byHandle << "s" << std::endl;
@@ -0,0 +1,42 @@
+/*
+pricing.py:
+
+import host
+
+def total(items):
+  total = 0.0
+  for item, quantity in items:
+    total += host.price(item, quantity)
+  host.log('priced %d items' % len(items))
+  return total
+
+def benchmark(count):
+  for i in xrange(count):
+    host.price('apple', i)
+*/
+
+// Host services called by the scripts
+double price(const std::string &item, long quantity) {
+  return (item == "apple" ? 0.5 : 1.0) * quantity;
+}
+
+void log(const std::string &message) {
+  std::cout << "pricing: " << message << std::endl;
+}
+
+PySession session;
+PyHostModule host("host");
+host.addFunction("price",price);
+host.addFunction("log",log);
+session.addModule(&host);
+session.importModule("pricing");
+
+std::vector<std::pair<std::string,long> > items;
+items.push_back(std::make_pair(std::string("apple"),3L));
+items.push_back(std::make_pair(std::string("pear"),2L));
+std::cout << session.call<double>("pricing","total",items) << std::endl;
+
+// Per call overhead of a host callback from a python loop
+clock_t start = clock();
+session.call<PyValue>("pricing","benchmark",1000000);
+std::cout << "host.price: " << double(clock()-start)/CLOCKS_PER_SEC*1000 << "ns per call" << std::endl;
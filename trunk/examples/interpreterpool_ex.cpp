@@ -0,0 +1,31 @@
+/*
+fetch.py:
+
+import urllib
+
+def fetch(url):
+  return len(urllib.urlopen(url).read())
+*/
+
+// Measure the throughput of 256 calls with 1 to 8 interpreters
+for (int interpreters=1;interpreters<=8;interpreters*=2) {
+  PyInterpreterPool pool(interpreters,false);
+  pool.importModule("fetch");
+
+  PyTuple url;
+  url.addValue(PyValue(std::string("http://www.google.com")));
+  PyValue urlArg(url);
+
+  time_t start = time(NULL);
+  std::vector<PyFuture*> futures;
+  for (int i=0;i<256;i++)
+    futures.push_back(pool.callFunctionAsync("fetch","fetch",&urlArg));
+  for (int i=0;i<256;i++)
+    futures[i]->wait();
+  double seconds = difftime(time(NULL),start);
+
+  PyAsyncStats stats = pool.asyncStats();
+  std::cout << interpreters << " interpreters: " << 256/seconds << " calls/s, "
+            << stats.stolen << " calls stolen" << std::endl;
+  pool.emptyResultBuffer();
+}
@@ -0,0 +1,33 @@
+/*
+orders.py:
+
+def rows(count):
+  for i in xrange(count):
+    yield {'id': i, 'amount': i * 0.5}
+
+def rowList(count):
+  return [{'id': i, 'amount': i * 0.5} for i in xrange(count)]
+*/
+
+PySession session;
+session.importModule("orders");
+
+// A million rows are pulled from the generator one at a time, in constant memory
+clock_t start = clock();
+double total = 0;
+PyIterator it = session.callFunctionIter("orders","rows",session.buildPyValue("(i)",1000000));
+for (; it != PyIterator(); ++it)
+  total += it->valueAsDict().value("amount").valueAsDouble();
+std::cout << "callFunctionIter: " << total << " " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+// The whole list is converted before the first row can be read
+start = clock();
+total = 0;
+const PyTuple &rows = session.callFunction("orders","rowList",session.buildPyValue("(i)",1000000))->valueAsTuple();
+for (PyTuple::const_iterator it_row = rows.begin(); it_row != rows.end(); ++it_row)
+  total += it_row->valueAsDict().value("amount").valueAsDouble();
+std::cout << "callFunction: " << total << " " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+session.emptyResultBuffer();
+
+// Any python object can be iterated, fx. the result of a method
+std::vector<PyValue> ids(PyIterator(&session,session.callFunctionRef("orders","rowList",session.buildPyValue("(i)",10))),PyIterator());
@@ -0,0 +1,23 @@
+/*
+catalog.py:
+
+def items(n):
+  return [{'id': i, 'name': 'item %d' % i, 'tags': ('new', 'sale')} for i in range(n)]
+*/
+
+PySession session;
+session.importModule("catalog");
+
+// Eager conversion copies every record into C++ before callFunction returns
+clock_t start = clock();
+PyValue *result = session.callFunction("catalog","items",session.buildPyValue("(i)",100000));
+std::cout << result->valueAsTuple().value(500).valueAsDict().value("name").valueAsString() << std::endl;
+std::cout << "eager: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+session.emptyResultBuffer();
+
+// Lazy conversion only converts the list and the one record which is read
+session.setLazyConversionEnabled(true);
+start = clock();
+result = session.callFunction("catalog","items",session.buildPyValue("(i)",100000));
+std::cout << result->valueAsTuple().value(500).valueAsDict().value("name").valueAsString() << std::endl;
+std::cout << "lazy: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
@@ -0,0 +1,66 @@
+/*
+work.py:
+
+def checksum(values):
+  total = 0
+  for i in range(20000):
+    total += values[i % len(values)]
+  return total
+*/
+
+// Wall clock time in seconds
+double now() {
+  struct timeval tv;
+  gettimeofday(&tv,NULL);
+  return tv.tv_sec + tv.tv_usec/1000000.0;
+}
+
+// Stores the completion time of a call
+void completed(PyFuture *future, void *userData) {
+  *(double *) userData = now();
+}
+
+// Throughput and 99th percentile latency of 1000 CPU bound calls,
+// on sub interpreters sharing the GIL and on worker processes
+PyTuple values;
+for (long i=0;i<100;i++)
+  values.addValue(PyValue(i));
+PyTuple args;
+args.addValue(PyValue(values));
+PyValue argsValue(args);
+
+for (int pass=0;pass<2;pass++) {
+  PyInterpreterPool *interpreters = pass == 0 ? new PyInterpreterPool(4,false) : NULL;
+  PyProcessPool *processes = pass == 1 ? new PyProcessPool(4,false) : NULL;
+  if (interpreters)
+    interpreters->importModule("work");
+  else
+    processes->importModule("work");
+
+  std::vector<PyFuture*> futures;
+  std::vector<double> sent(1000), done(1000), latencies;
+  double start = now();
+  for (int i=0;i<1000;i++) {
+    sent[i] = now();
+    futures.push_back(interpreters ? interpreters->callFunctionAsync("work","checksum",&argsValue,completed,&done[i])
+                                   : processes->callFunctionAsync("work","checksum",&argsValue,completed,&done[i]));
+  }
+  for (int i=0;i<1000;i++) {
+    futures[i]->wait();
+  }
+  double seconds = now()-start;
+  // Deleting the futures waits for the last callbacks to return
+  if (interpreters)
+    interpreters->emptyResultBuffer();
+  else
+    processes->emptyResultBuffer();
+  for (int i=0;i<1000;i++) {
+    latencies.push_back(done[i]-sent[i]);
+  }
+  std::sort(latencies.begin(),latencies.end());
+
+  std::cout << (interpreters ? "interpreters: " : "processes: ") << 1000/seconds << " calls/s, p99 "
+            << 1000*latencies[989] << " ms" << std::endl;
+  delete interpreters;
+  delete processes;
+}
@@ -1,4 +1,4 @@
-// Add the path (c:\alfa\python) to pythons sys.path
-PySession session;
-session.AddToPyPath("c:\\alfa\\python");
+// Add the path (c:\alfa\python) to pythons sys.path
+PySession session;
+session.AddToPyPath("c:\\alfa\\python");
 session.ShowPath();
\ No newline at end of file
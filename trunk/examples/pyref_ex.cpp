@@ -0,0 +1,28 @@
+/*
+pipeline.py:
+
+def load(n):
+  return [{'id': i, 'values': range(10)} for i in range(n)]
+
+def clean(rows, limit):
+  return [row for row in rows if row['id'] < limit]
+
+def count(rows):
+  return len(rows)
+*/
+
+PySession session;
+session.importModule("pipeline");
+
+// The rows stay python objects from one call to the next
+PyRef rows = session.callFunctionRef("pipeline","load",session.buildPyValue("(i)",100000));
+
+PyRefList args;
+args.push_back(rows);
+args.push_back(session.pyValueToPyRef(session.buildPyValue("i",500)));
+PyRef cleaned = session.callFunctionRef("pipeline","clean",args);
+
+args.clear();
+args.push_back(cleaned);
+// Only the final result is converted
+std::cout << session.callFunctionRef("pipeline","count",args).value().valueAsLong() << std::endl;
@@ -0,0 +1,20 @@
+/*
+handler.py:
+
+def handle(request):
+  return {'status': 200, 'length': len(request)}
+*/
+
+PySession session;
+session.importModule("handler");
+
+// Every request gets a scope, so the results of one request are freed when it is done
+// while the session lives on - no emptyResultBuffer() needed
+for (;;) {
+  PyResultScope scope(&session);
+  std::string request = readRequest();
+
+  PyValue *reply = session.callFunction("handler","handle",session.buildPyValue("(s)",request.c_str()));
+  if (reply)
+    writeReply(reply->str());
+}
@@ -0,0 +1,46 @@
+/*
+stats.py:
+
+def mean(values):
+  total = 0.0
+  count = 0
+  for value in values:
+    total += value
+    count += 1
+  return total / count
+*/
+
+// Produces the values of a sensor, one per call
+bool readSensor(double &value, void *userData) {
+  long *remaining = (long *) userData;
+  if (*remaining == 0)
+    return false;
+  (*remaining)--;
+  value = (*remaining % 100) * 0.5;
+  return true;
+}
+
+PySession session;
+session.importModule("stats");
+
+// Python iterates the vector directly, each element is converted as it is pulled
+std::vector<double> values(5000000,1.5);
+clock_t start = clock();
+std::cout << session.call<double>("stats","mean",pyIterate(values.begin(),values.end()));
+std::cout << " pyIterate: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+// The same values in a PyTuple are all converted, and held twice, before the call
+start = clock();
+PyTuple tuple;
+tuple.reserve(values.size());
+for (size_t i=0;i<values.size();i++)
+  tuple.addValue(PyValue(values[i]));
+PyTuple args;
+args.addValue(PyValue(tuple));
+PyValue argsValue(args);
+std::cout << session.callFunction("stats","mean",&argsValue)->valueAsDouble();
+std::cout << " PyTuple: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+// A generator function produces values until it returns false, in constant memory
+long remaining = 10000000;
+std::cout << session.call<double>("stats","mean",pyGenerate(readSensor,&remaining)) << std::endl;
@@ -0,0 +1,46 @@
+/*
+MyClass.py:
+
+import urllib
+import zlib
+
+class HTTPReadRaw:
+
+  def __init__(self,url):
+    self.source = urllib.urlopen(url).read()
+
+  def getSource(self):
+    return self.source
+
+def checksum(data):
+  return zlib.crc32(data)
+*/
+
+PySession session;
+session.importModule("MyClass");
+
+PyClass *cls = session.newInstance("MyClass","HTTPReadRaw",session.buildPyValue("(s)","http://www.google.com"));
+if (!cls)
+  return;
+
+// The body is read where python stored it, embedded NUL's included
+PyStringView source(cls->callMethodRef("getSource"));
+std::cout << source.size() << " bytes" << std::endl;
+std::cout << std::count(source.begin(),source.end(),'\n') << " lines" << std::endl;
+
+// A view is passed back to python as the string it was made from
+std::cout << session.call<long>("MyClass","checksum",source) << std::endl;
+
+// Copying it into a std::string, like callMethod() and valueAsString() do
+clock_t start = clock();
+for (int i=0;i<1000;i++) {
+  std::string copy = cls->callMethod("getSource")->valueAsString();
+  cls->emptyResultBuffer();
+}
+std::cout << "callMethod: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+start = clock();
+for (int i=0;i<1000;i++) {
+  PyStringView view(cls->callMethodRef("getSource"));
+}
+std::cout << "callMethodRef: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
@@ -0,0 +1,31 @@
+/*
+numbers.py:
+
+def numbers(n):
+  return tuple(range(n))
+*/
+
+PySession session;
+session.importModule("numbers");
+
+PyValue *result = session.callFunction("numbers","numbers",session.buildPyValue("(i)",1000000));
+const PyTuple &numbers = result->valueAsTuple();
+
+// Indexing is O(1), the values lie next to each other in memory
+clock_t start = clock();
+long sum = 0;
+for (int i=0;i<numbers.size();i++)
+  sum += numbers.value(i).valueAsLong();
+std::cout << "indexed: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+start = clock();
+sum = 0;
+for (PyTuple::const_iterator it_val = numbers.begin(); it_val != numbers.end(); ++it_val)
+  sum += it_val->valueAsLong();
+std::cout << "iterated: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+// Build a tuple in place, without copying the values
+PyTuple squares;
+squares.reserve(numbers.size());
+for (PyTuple::const_iterator it_val = numbers.begin(); it_val != numbers.end(); ++it_val)
+  squares.addValue().setValueAsLong(it_val->valueAsLong()*it_val->valueAsLong());
@@ -0,0 +1,35 @@
+/*
+scoring.py:
+
+def score(weight, name, factor):
+  return weight * factor + len(name)
+
+def totals(values):
+  return {'sum': sum(values), 'count': len(values)}
+*/
+
+PySession session;
+session.importModule("scoring");
+
+// Arguments and result are converted at compile time, no PyValue is built
+clock_t start = clock();
+double sum = 0;
+for (int i=0;i<100000;i++)
+  sum += session.call<double>("scoring","score",12L,std::string("abc"),3.5);
+std::cout << "call<double>: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+start = clock();
+sum = 0;
+for (int i=0;i<100000;i++) {
+  sum += session.callFunction("scoring","score",session.buildPyValue("(lsd)",12L,"abc",3.5))->valueAsDouble();
+  if (i%1000 == 999)
+    session.emptyResultBuffer();
+}
+std::cout << "callFunction: " << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+// Containers convert to lists and dicts
+std::vector<double> values;
+values.push_back(1.5);
+values.push_back(2.5);
+std::map<std::string,double> totals = session.call<std::map<std::string,double> >("scoring","totals",values);
+std::cout << totals["sum"] << " of " << totals["count"] << std::endl;
@@ -0,0 +1,37 @@
+/*
+text.py:
+# -*- coding: utf-8 -*-
+
+def document(size):
+  return u'plain ascii text ' * (size/17)
+
+def names():
+  return {u'city': u'København', u'country': u'Danmark'}
+
+def length(text):
+  return len(text)
+*/
+
+PySession session;
+session.importModule("text");
+
+// A 16 MB unicode string is copied to UTF-8 and back without python strings in between
+clock_t start = clock();
+PyValue *document = session.callFunction("text","document",session.buildPyValue("(i)",16*1024*1024));
+std::cout << document->valueAsString().size() << " bytes of UTF-8, ";
+std::cout << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+start = clock();
+PyTuple args;
+args.addValue(*document);
+PyValue argsValue(args);
+std::cout << session.callFunction("text","length",&argsValue)->valueAsLong() << " characters, ";
+std::cout << double(clock()-start)/CLOCKS_PER_SEC << "s" << std::endl;
+
+// Non-ASCII text is encoded as UTF-8, unicode keys are found by string lookups
+const PyDict &names = session.callFunction("text","names")->valueAsDict();
+std::cout << names.value("city").valueAsString() << std::endl;
+
+PyValue city;
+city.setValueAsUnicode("Malm\xc3\xb6");
+std::cout << city.str() << std::endl;
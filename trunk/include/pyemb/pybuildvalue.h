@@ -0,0 +1 @@
+#include "../../src/pybuildvalue.h"
\ No newline at end of file
@@ -1 +1 @@
-#include "../../src/pyclass.h"
+#include "../../src/pyclass.h"
@@ -0,0 +1 @@
+#include "../../src/pyconverter.h"
\ No newline at end of file
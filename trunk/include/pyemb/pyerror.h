@@ -1 +1 @@
-#include "../../src/pyerror.h"
+#include "../../src/pyerror.h"
@@ -0,0 +1 @@
+#include "../../src/pyfunction.h"
@@ -0,0 +1 @@
+#include "../../src/pyfuture.h"
@@ -0,0 +1 @@
+#include "../../src/pygil.h"
@@ -0,0 +1 @@
+#include "../../src/pyhostmodule.h"
\ No newline at end of file
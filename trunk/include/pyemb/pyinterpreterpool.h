@@ -0,0 +1 @@
+#include "../../src/pyinterpreterpool.h"
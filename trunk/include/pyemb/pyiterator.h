@@ -0,0 +1 @@
+#include "../../src/pyiterator.h"
\ No newline at end of file
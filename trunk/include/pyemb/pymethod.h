@@ -0,0 +1 @@
+#include "../../src/pymethod.h"
@@ -0,0 +1 @@
+#include "../../src/pyprocesspool.h"
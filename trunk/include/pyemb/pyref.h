@@ -0,0 +1 @@
+#include "../../src/pyref.h"
\ No newline at end of file
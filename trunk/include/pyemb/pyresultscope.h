@@ -0,0 +1 @@
+#include "../../src/pyresultscope.h"
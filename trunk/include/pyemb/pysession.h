@@ -1 +1 @@
-#include "../../src/pysession.h"
+#include "../../src/pysession.h"
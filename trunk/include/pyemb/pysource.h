@@ -0,0 +1 @@
+#include "../../src/pysource.h"
\ No newline at end of file
@@ -0,0 +1 @@
+#include "../../src/pystringview.h"
\ No newline at end of file
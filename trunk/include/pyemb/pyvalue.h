@@ -1 +1 @@
-#include "../../src/pyvalue.h"
+#include "../../src/pyvalue.h"
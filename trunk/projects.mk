@@ -1,21 +1,56 @@
-PROJECTS = pyemb
-
-OBJECTS_DIR = obj_$(if $(DEBUG),debug,release)
-DESTDIR = bin_$(if $(DEBUG),debug,release)
-pyemb_TARGETS = $(DESTDIR)/pyemb_$(PYEMB_VERSION).dll
-
-$(pyemb_TARGETS)_SOURCES = \
-    src/pysession.cpp \
-    src/pyerror.cpp \
-    src/pyvalue.cpp \
-    src/pyclass.cpp
-
-$(pyemb_TARGETS)_HEADERS = \
-	src/pyembdef.h \
-    src/cdebug.h \
-    src/pysession.h \
-    src/pyerror.h \
-    src/pyvalue.h \
-    src/pyclass.h
-
+PROJECTS = pyemb
+
+OBJECTS_DIR = obj_$(if $(DEBUG),debug,release)
+DESTDIR = bin_$(if $(DEBUG),debug,release)
+pyemb_TARGETS = $(DESTDIR)/pyemb_$(PYEMB_VERSION).dll
+
+$(pyemb_TARGETS)_SOURCES = \
+    src/pysession.cpp \
+    src/pyerror.cpp \
+    src/pyvalue.cpp \
+    src/pyclass.cpp \
+    src/pyfunction.cpp \
+    src/pymethod.cpp \
+    src/pygil.cpp \
+    src/pyfuture.cpp \
+    src/pycallqueue.cpp \
+    src/pyinterpreterpool.cpp \
+    src/pyvaluecodec.cpp \
+    src/pyshmring.cpp \
+    src/pyprocesspool.cpp \
+    src/pyresultscope.cpp \
+    src/pyref.cpp \
+    src/pyconverter.cpp \
+    src/pyunicode.cpp \
+    src/pystringview.cpp \
+    src/pyiterator.cpp \
+    src/pysource.cpp \
+    src/pyhostmodule.cpp
+
+$(pyemb_TARGETS)_HEADERS = \
+	src/pyembdef.h \
+    src/cdebug.h \
+    src/pysession.h \
+    src/pyerror.h \
+    src/pyvalue.h \
+    src/pyclass.h \
+    src/pyfunction.h \
+    src/pymethod.h \
+    src/pygil.h \
+    src/pyfuture.h \
+    src/pycallqueue.h \
+    src/pyinterpreterpool.h \
+    src/pyvaluecodec.h \
+    src/pyshmring.h \
+    src/pyprocesspool.h \
+    src/pyresultscope.h \
+    src/pyref.h \
+    src/pyconverter.h \
+    src/pybuildvalue.h \
+    src/pyunicode.h \
+    src/pystringview.h \
+    src/pyiterator.h \
+    src/pysource.h \
+    src/pyhostmodule.h
+
 CXXFLAGS += /DPYEMB_DLL
\ No newline at end of file
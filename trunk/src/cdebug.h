@@ -2,15 +2,12 @@
 #define CDEBUG_H
 
 #include <iostream>
-struct nullstream:
-std::ostream {
-	nullstream(): std::ios(0), std::ostream(0) {}
-};
 
 #ifdef _DEBUG
 #define CDEBUG std::cout
 #else
-#define CDEBUG nullstream()
+// The stream expression is compiled but never evaluated
+#define CDEBUG while (false) std::cout
 #endif
 
 #endif
@@ -0,0 +1,281 @@
+#ifndef PYBUILDVALUE_H
+#define PYBUILDVALUE_H
+
+#include "pyembdef.h"
+#include "pyvalue.h"
+#include <vector>
+#include <map>
+#include <string>
+
+namespace PyEmb {
+	/** \struct PyValueSetter
+ PyValueSetter<T>::set() stores a T in a PyValue. It is the type-safe replacement for the format units of
+ PySession::buildPyValue(): pyTuple() and pyDict() pick the setter of every argument at compile time, so
+ there is no format to get wrong or to parse, and the PyValue is built without any python objects.
+ A type without a setter does not compile.
+ <br><br>
+ Setters are provided for long, int, bool, double, std::string, C strings, PyValue, PyTuple, PyDict,
+ std::vector (tuples), std::map (dicts) and std::pair (two element tuples). Other types, fx. structs,
+ are supported by specializing PyValueSetter. Examples, to the right the format they replace:
+ <br><br>
+ pyTuple()                                   "()" <br>
+ pyTuple(123)                                "(i)" <br>
+ pyTuple(123L, "hello", 2.5)                 "(lsd)" <br>
+ pyTuple(pyTuple(1,2), pyTuple(3,4))         "((ii)(ii))" <br>
+ pyDict("abc", 123, "def", 456)              "{s:i,s:i}" <br>
+*/
+	template<class T> struct PyValueSetter;
+
+	template<> struct PyValueSetter<long> {
+		static void set(PyValue &value, long item) {value.setValueAsLong(item);}
+	};
+
+	template<> struct PyValueSetter<int> {
+		static void set(PyValue &value, int item) {value.setValueAsLong(item);}
+	};
+
+	/* Python converts True and False to 1 and 0 as well */
+	template<> struct PyValueSetter<bool> {
+		static void set(PyValue &value, bool item) {value.setValueAsLong(item);}
+	};
+
+	template<> struct PyValueSetter<double> {
+		static void set(PyValue &value, double item) {value.setValueAsDouble(item);}
+	};
+
+	template<> struct PyValueSetter<std::string> {
+		static void set(PyValue &value, const std::string &item) {value.setValueAsString(item);}
+	};
+
+	template<> struct PyValueSetter<const char *> {
+		static void set(PyValue &value, const char *item) {value.setValueAsString(item);}
+	};
+
+	template<> struct PyValueSetter<char *> {
+		static void set(PyValue &value, const char *item) {value.setValueAsString(item);}
+	};
+
+	/* String literals are deduced as arrays */
+	template<size_t N> struct PyValueSetter<char[N]> {
+		static void set(PyValue &value, const char *item) {value.setValueAsString(item);}
+	};
+
+	template<> struct PyValueSetter<PyValue> {
+		static void set(PyValue &value, const PyValue &item) {value = item;}
+	};
+
+	/* Tuples and dicts are built in place in the value */
+	template<> struct PyValueSetter<PyTuple> {
+		static void set(PyValue &value, const PyTuple &item) {value.setValueAsTuple(item);}
+		static PyTuple &newTuple(PyValue &value, int size) {
+			PyTuple *tuple = new PyTuple();
+			tuple->reserve(size);
+			value.shareTuple(tuple);
+			return *tuple;
+		}
+	};
+
+	template<> struct PyValueSetter<PyDict> {
+		static void set(PyValue &value, const PyDict &item) {value.setValueAsDict(item);}
+		static PyDict &newDict(PyValue &value, int size) {
+			PyDict *dict = new PyDict();
+			dict->reserve(size);
+			value.shareDict(dict);
+			return *dict;
+		}
+	};
+
+	template<class T> struct PyValueSetter<std::vector<T> > {
+		static void set(PyValue &value, const std::vector<T> &item) {
+			PyTuple &tuple = PyValueSetter<PyTuple>::newTuple(value,(int) item.size());
+			for (size_t i=0;i<item.size();i++) {
+				PyValueSetter<T>::set(tuple.addValue(),item[i]);
+			}
+		}
+	};
+
+	template<class K, class V> struct PyValueSetter<std::map<K,V> > {
+		static void set(PyValue &value, const std::map<K,V> &item) {
+			PyDict &dict = PyValueSetter<PyDict>::newDict(value,(int) item.size());
+			typename std::map<K,V>::const_iterator it_val = item.begin();
+			for (; it_val != item.end(); ++it_val) {
+				PyValue key, val;
+				PyValueSetter<K>::set(key,it_val->first);
+				PyValueSetter<V>::set(val,it_val->second);
+				dict.setValue(key,val);
+			}
+		}
+	};
+
+	template<class A, class B> struct PyValueSetter<std::pair<A,B> > {
+		static void set(PyValue &value, const std::pair<A,B> &item) {
+			PyTuple &tuple = PyValueSetter<PyTuple>::newTuple(value,2);
+			PyValueSetter<A>::set(tuple.addValue(),item.first);
+			PyValueSetter<B>::set(tuple.addValue(),item.second);
+		}
+	};
+
+	/** \brief Tuple of the arguments, fx. the arguments of PySession::callFunction() */
+	inline PyValue pyTuple() {
+		PyValue value;
+		PyValueSetter<PyTuple>::newTuple(value,0);
+		return value;
+	}
+
+	template<class A1>
+	PyValue pyTuple(const A1 &a1) {
+		PyValue value;
+		PyTuple &tuple = PyValueSetter<PyTuple>::newTuple(value,1);
+		PyValueSetter<A1>::set(tuple.addValue(),a1);
+		return value;
+	}
+
+	template<class A1, class A2>
+	PyValue pyTuple(const A1 &a1, const A2 &a2) {
+		PyValue value;
+		PyTuple &tuple = PyValueSetter<PyTuple>::newTuple(value,2);
+		PyValueSetter<A1>::set(tuple.addValue(),a1);
+		PyValueSetter<A2>::set(tuple.addValue(),a2);
+		return value;
+	}
+
+	template<class A1, class A2, class A3>
+	PyValue pyTuple(const A1 &a1, const A2 &a2, const A3 &a3) {
+		PyValue value;
+		PyTuple &tuple = PyValueSetter<PyTuple>::newTuple(value,3);
+		PyValueSetter<A1>::set(tuple.addValue(),a1);
+		PyValueSetter<A2>::set(tuple.addValue(),a2);
+		PyValueSetter<A3>::set(tuple.addValue(),a3);
+		return value;
+	}
+
+	template<class A1, class A2, class A3, class A4>
+	PyValue pyTuple(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4) {
+		PyValue value;
+		PyTuple &tuple = PyValueSetter<PyTuple>::newTuple(value,4);
+		PyValueSetter<A1>::set(tuple.addValue(),a1);
+		PyValueSetter<A2>::set(tuple.addValue(),a2);
+		PyValueSetter<A3>::set(tuple.addValue(),a3);
+		PyValueSetter<A4>::set(tuple.addValue(),a4);
+		return value;
+	}
+
+	template<class A1, class A2, class A3, class A4, class A5>
+	PyValue pyTuple(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5) {
+		PyValue value;
+		PyTuple &tuple = PyValueSetter<PyTuple>::newTuple(value,5);
+		PyValueSetter<A1>::set(tuple.addValue(),a1);
+		PyValueSetter<A2>::set(tuple.addValue(),a2);
+		PyValueSetter<A3>::set(tuple.addValue(),a3);
+		PyValueSetter<A4>::set(tuple.addValue(),a4);
+		PyValueSetter<A5>::set(tuple.addValue(),a5);
+		return value;
+	}
+
+	template<class A1, class A2, class A3, class A4, class A5, class A6>
+	PyValue pyTuple(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6) {
+		PyValue value;
+		PyTuple &tuple = PyValueSetter<PyTuple>::newTuple(value,6);
+		PyValueSetter<A1>::set(tuple.addValue(),a1);
+		PyValueSetter<A2>::set(tuple.addValue(),a2);
+		PyValueSetter<A3>::set(tuple.addValue(),a3);
+		PyValueSetter<A4>::set(tuple.addValue(),a4);
+		PyValueSetter<A5>::set(tuple.addValue(),a5);
+		PyValueSetter<A6>::set(tuple.addValue(),a6);
+		return value;
+	}
+
+	template<class A1, class A2, class A3, class A4, class A5, class A6, class A7>
+	PyValue pyTuple(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7) {
+		PyValue value;
+		PyTuple &tuple = PyValueSetter<PyTuple>::newTuple(value,7);
+		PyValueSetter<A1>::set(tuple.addValue(),a1);
+		PyValueSetter<A2>::set(tuple.addValue(),a2);
+		PyValueSetter<A3>::set(tuple.addValue(),a3);
+		PyValueSetter<A4>::set(tuple.addValue(),a4);
+		PyValueSetter<A5>::set(tuple.addValue(),a5);
+		PyValueSetter<A6>::set(tuple.addValue(),a6);
+		PyValueSetter<A7>::set(tuple.addValue(),a7);
+		return value;
+	}
+
+	template<class A1, class A2, class A3, class A4, class A5, class A6, class A7, class A8>
+	PyValue pyTuple(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8) {
+		PyValue value;
+		PyTuple &tuple = PyValueSetter<PyTuple>::newTuple(value,8);
+		PyValueSetter<A1>::set(tuple.addValue(),a1);
+		PyValueSetter<A2>::set(tuple.addValue(),a2);
+		PyValueSetter<A3>::set(tuple.addValue(),a3);
+		PyValueSetter<A4>::set(tuple.addValue(),a4);
+		PyValueSetter<A5>::set(tuple.addValue(),a5);
+		PyValueSetter<A6>::set(tuple.addValue(),a6);
+		PyValueSetter<A7>::set(tuple.addValue(),a7);
+		PyValueSetter<A8>::set(tuple.addValue(),a8);
+		return value;
+	}
+
+	/** \brief Dict of key and value arguments */
+	template<class K1, class V1>
+	PyValue pyDict(const K1 &k1, const V1 &v1) {
+		PyValue value;
+		PyDict &dict = PyValueSetter<PyDict>::newDict(value,1);
+		PyValue key, val;
+		PyValueSetter<K1>::set(key,k1);
+		PyValueSetter<V1>::set(val,v1);
+		dict.setValue(key,val);
+		return value;
+	}
+
+	template<class K1, class V1, class K2, class V2>
+	PyValue pyDict(const K1 &k1, const V1 &v1, const K2 &k2, const V2 &v2) {
+		PyValue value;
+		PyDict &dict = PyValueSetter<PyDict>::newDict(value,2);
+		PyValue key, val;
+		PyValueSetter<K1>::set(key,k1);
+		PyValueSetter<V1>::set(val,v1);
+		dict.setValue(key,val);
+		PyValueSetter<K2>::set(key,k2);
+		PyValueSetter<V2>::set(val,v2);
+		dict.setValue(key,val);
+		return value;
+	}
+
+	template<class K1, class V1, class K2, class V2, class K3, class V3>
+	PyValue pyDict(const K1 &k1, const V1 &v1, const K2 &k2, const V2 &v2, const K3 &k3, const V3 &v3) {
+		PyValue value;
+		PyDict &dict = PyValueSetter<PyDict>::newDict(value,3);
+		PyValue key, val;
+		PyValueSetter<K1>::set(key,k1);
+		PyValueSetter<V1>::set(val,v1);
+		dict.setValue(key,val);
+		PyValueSetter<K2>::set(key,k2);
+		PyValueSetter<V2>::set(val,v2);
+		dict.setValue(key,val);
+		PyValueSetter<K3>::set(key,k3);
+		PyValueSetter<V3>::set(val,v3);
+		dict.setValue(key,val);
+		return value;
+	}
+
+	template<class K1, class V1, class K2, class V2, class K3, class V3, class K4, class V4>
+	PyValue pyDict(const K1 &k1, const V1 &v1, const K2 &k2, const V2 &v2, const K3 &k3, const V3 &v3, const K4 &k4, const V4 &v4) {
+		PyValue value;
+		PyDict &dict = PyValueSetter<PyDict>::newDict(value,4);
+		PyValue key, val;
+		PyValueSetter<K1>::set(key,k1);
+		PyValueSetter<V1>::set(val,v1);
+		dict.setValue(key,val);
+		PyValueSetter<K2>::set(key,k2);
+		PyValueSetter<V2>::set(val,v2);
+		dict.setValue(key,val);
+		PyValueSetter<K3>::set(key,k3);
+		PyValueSetter<V3>::set(val,v3);
+		dict.setValue(key,val);
+		PyValueSetter<K4>::set(key,k4);
+		PyValueSetter<V4>::set(val,v4);
+		dict.setValue(key,val);
+		return value;
+	}
+}
+
+#endif
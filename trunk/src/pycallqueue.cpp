@@ -0,0 +1,190 @@
+#include <Python.h>
+#include <pythread.h>
+#include "pycallqueue.h"
+#include "pysession.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+namespace PyEmb {
+	/* Wall clock time in seconds */
+	static double wallTime() {
+#ifdef WIN32
+		LARGE_INTEGER frequency, counter;
+		QueryPerformanceFrequency(&frequency);
+		QueryPerformanceCounter(&counter);
+		return double(counter.QuadPart)/frequency.QuadPart;
+#else
+		struct timeval tv;
+		gettimeofday(&tv,NULL);
+		return tv.tv_sec + tv.tv_usec/1000000.0;
+#endif
+	}
+
+	PyCallQueue::PyCallQueue(PySession *session) {
+		m_session = session;
+		m_siblings = NULL;
+		m_waiting = false;
+		m_stop = false;
+		m_joined = false;
+		m_queued = 0;
+		m_completed = 0;
+		m_stolen = 0;
+		m_maxDepth = 0;
+		m_totalWait = 0.0;
+		m_maxWait = 0.0;
+		m_lock = PyThread_allocate_lock();
+		// m_wakeup and m_threadDone are used as binary semaphores and start out taken
+		m_wakeup = PyThread_allocate_lock();
+		PyThread_acquire_lock(m_wakeup,WAIT_LOCK);
+		m_threadDone = PyThread_allocate_lock();
+		PyThread_acquire_lock(m_threadDone,WAIT_LOCK);
+		PyThread_start_new_thread(threadMain,this);
+	}
+
+	PyCallQueue::~PyCallQueue() {
+		stop();
+		PyThread_free_lock(m_threadDone);
+		PyThread_free_lock(m_wakeup);
+		PyThread_free_lock(m_lock);
+	}
+
+	/* Runs the calls already queued, then stops the interpreter thread and waits for it */
+	void PyCallQueue::stop() {
+		if (m_joined)
+			return;
+		push(NULL);
+		PyThread_acquire_lock(m_threadDone,WAIT_LOCK);
+		m_joined = true;
+	}
+
+	void PyCallQueue::push(PyAsyncCall *call) {
+		PyThread_acquire_lock(m_lock,WAIT_LOCK);
+		if (call) {
+			call->queuedAt = wallTime();
+			m_calls.push_back(call);
+			m_queued++;
+			if ((int) m_calls.size() > m_maxDepth)
+				m_maxDepth = m_calls.size();
+		}
+		else {
+			m_stop = true;
+		}
+		if (m_waiting) {
+			m_waiting = false;
+			PyThread_release_lock(m_wakeup);
+		}
+		PyThread_release_lock(m_lock);
+	}
+
+	/* Queues sharing function calls with this one - the array must outlive the queue */
+	void PyCallQueue::setSiblings(PyCallQueueArray *siblings) {
+		m_siblings = siblings;
+	}
+
+	/* Number of calls waiting */
+	int PyCallQueue::depth() {
+		PyThread_acquire_lock(m_lock,WAIT_LOCK);
+		int depth = m_calls.size();
+		PyThread_release_lock(m_lock);
+		return depth;
+	}
+
+	/* Next call to run, waits while the queue is empty. Returns NULL when stopped */
+	PyAsyncCall *PyCallQueue::pop() {
+		for (;;) {
+			PyThread_acquire_lock(m_lock,WAIT_LOCK);
+			PyAsyncCall *call = NULL;
+			if (!m_calls.empty()) {
+				call = m_calls.front();
+				m_calls.pop_front();
+			}
+			else if (!m_stop) {
+				PyThread_release_lock(m_lock);
+				call = steal();
+				PyThread_acquire_lock(m_lock,WAIT_LOCK);
+			}
+			if (call) {
+				double wait = wallTime()-call->queuedAt;
+				m_totalWait += wait;
+				if (wait > m_maxWait)
+					m_maxWait = wait;
+				PyThread_release_lock(m_lock);
+				return call;
+			}
+			if (m_stop) {
+				PyThread_release_lock(m_lock);
+				return NULL;
+			}
+			if (m_calls.empty()) {
+				m_waiting = true;
+				PyThread_release_lock(m_lock);
+				PyThread_acquire_lock(m_wakeup,WAIT_LOCK);
+			}
+			else {
+				PyThread_release_lock(m_lock);
+			}
+		}
+	}
+
+	/* Take the newest function call from the first sibling which has one. Method calls
+	   and other calls bound to an interpreter are never stolen */
+	PyAsyncCall *PyCallQueue::steal() {
+		if (!m_siblings)
+			return NULL;
+		PyCallQueueArray::iterator it_queue = m_siblings->begin();
+		for (; it_queue != m_siblings->end(); ++it_queue) {
+			PyCallQueue *sibling = *it_queue;
+			if (sibling == this)
+				continue;
+			PyThread_acquire_lock(sibling->m_lock,WAIT_LOCK);
+			if (!sibling->m_stop && !sibling->m_calls.empty() &&
+				sibling->m_calls.back()->kind == PyAsyncCall::FunctionCall) {
+				PyAsyncCall *call = sibling->m_calls.back();
+				sibling->m_calls.pop_back();
+				PyThread_release_lock(sibling->m_lock);
+				PyThread_acquire_lock(m_lock,WAIT_LOCK);
+				m_stolen++;
+				PyThread_release_lock(m_lock);
+				return call;
+			}
+			PyThread_release_lock(sibling->m_lock);
+		}
+		return NULL;
+	}
+
+	void PyCallQueue::threadMain(void *queue) {
+		((PyCallQueue *) queue)->run();
+	}
+
+	void PyCallQueue::run() {
+		PyAsyncCall *call;
+		m_session->startInterpreter();
+		while ((call = pop()) != NULL) {
+			m_session->runAsyncCall(call);
+			delete call;
+			PyThread_acquire_lock(m_lock,WAIT_LOCK);
+			m_completed++;
+			PyThread_release_lock(m_lock);
+		}
+		m_session->endInterpreter();
+		PyThread_release_lock(m_threadDone);
+	}
+
+	PyAsyncStats PyCallQueue::stats() {
+		PyAsyncStats stats;
+		PyThread_acquire_lock(m_lock,WAIT_LOCK);
+		stats.queued = m_queued;
+		stats.completed = m_completed;
+		stats.stolen = m_stolen;
+		stats.depth = m_calls.size();
+		stats.maxDepth = m_maxDepth;
+		stats.totalWait = m_totalWait;
+		stats.maxWait = m_maxWait;
+		PyThread_release_lock(m_lock);
+		return stats;
+	}
+}
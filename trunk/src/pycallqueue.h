@@ -0,0 +1,70 @@
+#ifndef PYCALLQUEUE_H
+#define PYCALLQUEUE_H
+
+#include "pysession.h"
+
+#include <deque>
+#include <vector>
+#include <string>
+
+typedef void *PyThread_type_lock;
+
+namespace PyEmb {
+	class PyClass;
+	class PyFuture;
+
+	/* A call waiting for the interpreter thread */
+	struct PyAsyncCall {
+		enum Kind {FunctionCall,MethodCall,ModuleImport,PathAppend,InstanceCreation};
+
+		Kind kind;
+		std::string moduleName;		// module name, or path for PathAppend
+		std::string functionName;	// function, method or class name
+		PyClass *instance;			// MethodCall only
+		PyValue args;
+		bool hasArgs;
+		PyFuture *future;
+		double queuedAt;
+	};
+
+	typedef std::deque<PyAsyncCall*> PyAsyncCallQueue;
+
+	/* Queue of asynchronous calls, drained by a dedicated interpreter thread
+	   which is started by the constructor and stopped by the destructor.
+	   Queues of a PyInterpreterPool steal function calls from their siblings when idle */
+	class PyCallQueue {
+
+	public:
+		PyCallQueue(PySession *session);
+		~PyCallQueue();
+		void push(PyAsyncCall *call);
+		void stop();
+		void setSiblings(PyCallQueueArray *siblings);
+		int depth();
+		PyAsyncStats stats();
+
+	private:
+		static void threadMain(void *queue);
+		void run();
+		PyAsyncCall *pop();
+		PyAsyncCall *steal();
+
+		PySession *m_session;
+		PyCallQueueArray *m_siblings;
+		PyAsyncCallQueue m_calls;
+		PyThread_type_lock m_lock;
+		PyThread_type_lock m_wakeup;
+		PyThread_type_lock m_threadDone;
+		bool m_waiting;
+		bool m_stop;
+		bool m_joined;
+		long m_queued;
+		long m_completed;
+		long m_stolen;
+		int m_maxDepth;
+		double m_totalWait;
+		double m_maxWait;
+	};
+}
+
+#endif
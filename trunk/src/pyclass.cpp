@@ -1,68 +1,213 @@
-#include <Python.h>
-#include "pyclass.h"
-#include "pysession.h"
-
-#include <sstream>
-
-namespace PyEmb {
-	PyClass::PyClass(PyObject *instance,PySession *session) {
-		m_session = session;
-		m_instance=instance;
-	}
-
-	PyClass::~PyClass() {
-		emptyResultBuffer();
-		Py_DECREF(m_instance);
-	}
-
-
-	/**
-Call classmethod <i>Method</i> passing arguments through <i>Args</i>
-Use PySession::BuildPyValue() to create the argument.
-*/
-	PyValue *PyClass::callMethod(const std::string &methodName, PyValue *args) {
-
-		PyObject *pValue,*pArgs,*pFunc = 0;
-		PyValue *result=NULL;
-		pFunc = PyObject_GetAttrString(m_instance, methodName.c_str());
-		if (pFunc == NULL) {
-			PyErr_SetString(PyExc_AttributeError, methodName.c_str());
-			return 0;
-		}
-
-		if (!PyCallable_Check(pFunc)) {
-			return 0;
-		}
-
-		pArgs = m_session->pyValueToPyObject(args,true);
-
-		pValue = PyObject_Call(pFunc,pArgs, NULL);
-		if (pArgs) {
-			Py_DECREF(pArgs);
-		}
-		if (pValue) {
-			result = new PyValue(pValue);
-			Py_DECREF(pValue);
-			m_resultbuffer.push_back(result);
-			return result;
-		}
-		else {
-			std::ostringstream doingwhat;
-			doingwhat << "Calling method" << methodName << std::endl;
-			m_session->m_lastError.setDoingWhat(doingwhat.str());
-			m_session->storeError(&m_session->m_lastError);
-			if (m_session->autoAlertEnabled()) {
-				m_session->raiseErrorMessage();
-			}
-			return result;
-		}
-	}
-
-	void PyClass::emptyResultBuffer() {
-		PyValueArray::iterator it_val = m_resultbuffer.begin();
-		for (; it_val != m_resultbuffer.end(); ++it_val) {
-			delete *it_val;
-		}
-		m_resultbuffer.erase(m_resultbuffer.begin(),m_resultbuffer.end());
-	}
-}
+#include <Python.h>
+#include "pyclass.h"
+#include "pymethod.h"
+#include "pysession.h"
+#include "pygil.h"
+#include "pycallqueue.h"
+
+#include <sstream>
+
+namespace PyEmb {
+	PyClass::PyClass(PyObject *instance,PySession *session) {
+		m_session = session;
+		m_instance=instance;
+	}
+
+	PyClass::~PyClass() {
+		PyGILLock lock;
+		PyMethodArray::iterator it_meth = m_methods.begin();
+		for (; it_meth != m_methods.end(); ++it_meth) {
+			delete *it_meth;
+		}
+		Py_DECREF(m_instance);
+	}
+
+
+	/**
+Call classmethod <i>Method</i> passing arguments through <i>Args</i>
+Use PySession::BuildPyValue() to create the argument.
+*/
+	PyValue *PyClass::callMethod(const std::string &methodName, PyValue *args) {
+		if (m_session->m_pool) {
+			// Instances of a PyInterpreterPool are called on the interpreter thread
+			PyFuture *future = callMethodAsync(methodName,args);
+			if (!future->ok()) {
+				*m_session->lastError() = future->error();
+				return NULL;
+			}
+			return &future->m_value;
+		}
+		PyGILLock lock;
+
+		PyObject *pValue,*pArgs,*pFunc = 0;
+		pFunc = PyObject_GetAttrString(m_instance, methodName.c_str());
+		if (pFunc == NULL) {
+			PyErr_SetString(PyExc_AttributeError, methodName.c_str());
+			return 0;
+		}
+
+		if (!PyCallable_Check(pFunc)) {
+			Py_DECREF(pFunc);
+			return 0;
+		}
+
+		pArgs = m_session->pyValueToPyObject(args,true);
+
+		pValue = PyObject_Call(pFunc,pArgs, NULL);
+		Py_DECREF(pFunc);
+		if (pArgs) {
+			Py_DECREF(pArgs);
+		}
+		return methodResult(pValue,methodName);
+	}
+
+	/**
+Call classmethod <i>Method</i> and return the result by value, see PySession::callFunctionResult().
+*/
+	PyResult PyClass::callMethodResult(const std::string &methodName, PyValue *args) {
+		PyResult result;
+		if (m_session->m_pool) {
+			PyFuture *future = callMethodAsync(methodName,args);
+			result.ok = future->ok();
+			result.value.swap(future->m_value);
+			result.error = future->error();
+			return result;
+		}
+		PyGILLock lock;
+		std::ostringstream doingwhat;
+		doingwhat << "Calling method " << methodName << std::endl;
+		PyObject *pFunc = PyObject_GetAttrString(m_instance, methodName.c_str());
+		if (pFunc == NULL || !PyCallable_Check(pFunc)) {
+			Py_XDECREF(pFunc);
+			m_session->reportError(doingwhat.str());
+			result.error = *m_session->lastError();
+			return result;
+		}
+		PyObject *pArgs = m_session->pyValueToPyObject(args,true);
+		m_session->callResult(pFunc,pArgs,doingwhat.str(),result);
+		Py_DECREF(pFunc);
+		Py_XDECREF(pArgs);
+		return result;
+	}
+
+	/**
+Call classmethod <i>Method</i> and return the result unconverted, see PySession::callFunctionRef().
+*/
+	PyRef PyClass::callMethodRef(const std::string &methodName, PyValue *args) {
+		PyGILLock lock;
+		PyObject *pArgs = m_session->pyValueToPyObject(args,true);
+		PyRef result = methodRef(methodName,pArgs);
+		Py_XDECREF(pArgs);
+		return result;
+	}
+
+	/**
+Call classmethod <i>Method</i> with python objects as arguments, see PySession::callFunctionRef().
+*/
+	PyRef PyClass::callMethodRef(const std::string &methodName, const PyRefList &args) {
+		PyGILLock lock;
+		PyObject *pArgs = m_session->refArguments(args);
+		PyRef result = methodRef(methodName,pArgs);
+		Py_DECREF(pArgs);
+		return result;
+	}
+
+	/* Call with the GIL held */
+	PyRef PyClass::methodRef(const std::string &methodName, PyObject *pArgs) {
+		std::ostringstream doingwhat;
+		doingwhat << "Calling method " << methodName << std::endl;
+		if (m_session->m_pool) {
+			// The objects of a sub interpreter stay on its interpreter thread
+			PyError *error = m_session->lastError();
+			error->setDoingWhat(doingwhat.str());
+			error->setException("NotImplementedError");
+			error->setExceptionValue("Instances of a PyInterpreterPool can not return a PyRef");
+			return PyRef();
+		}
+		PyObject *pFunc = PyObject_GetAttrString(m_instance, methodName.c_str());
+		if (pFunc == NULL || !PyCallable_Check(pFunc)) {
+			Py_XDECREF(pFunc);
+			m_session->reportError(doingwhat.str());
+			return PyRef();
+		}
+		PyRef result = m_session->callRef(pFunc,pArgs,doingwhat.str());
+		Py_DECREF(pFunc);
+		return result;
+	}
+
+	/**
+Resolve classmethod <i>Method</i> once for repeated calls. See PyMethodHandle.
+The handle is owned by the PyClass instance.
+*/
+	PyMethodHandle *PyClass::resolveMethod(const std::string &methodName) {
+		PyGILLock lock;
+		PyMethodHandle *handle = new PyMethodHandle(this,methodName);
+		m_methods.push_back(handle);
+		return handle;
+	}
+
+	/**
+Call classmethod <i>Method</i> asynchronously, see PySession::callFunctionAsync().
+The future is owned by the PySession.
+*/
+	PyFuture *PyClass::callMethodAsync(const std::string &methodName, PyValue *args,
+		PyFutureCallback callback, void *userData) {
+		PyAsyncCall *call = new PyAsyncCall;
+		call->kind = PyAsyncCall::MethodCall;
+		call->functionName = methodName;
+		call->instance = this;
+		return m_session->queueCall(call,args,callback,userData);
+	}
+
+	/* Store the result of a method call, or the error if the call failed. pValue is DECREF'ed */
+	PyValue *PyClass::methodResult(PyObject *pValue, const std::string &methodName) {
+		PyValue *result=NULL;
+		if (pValue) {
+			result = m_session->storeResult(pValue);
+			Py_DECREF(pValue);
+			return result;
+		}
+		else {
+			std::ostringstream doingwhat;
+			doingwhat << "Calling method " << methodName << std::endl;
+			m_session->reportError(doingwhat.str());
+			return result;
+		}
+	}
+
+	/**
+Call classmethod <i>Method</i> once for every element in <i>Args</i>.
+The method is looked up once, see PySession::callFunctionBatch() for how results and
+errors are reported. Instances of a PyInterpreterPool queue every call for their interpreter thread.
+*/
+	PyBatchResultArray PyClass::callMethodBatch(const std::string &methodName, const PyValueList &args) {
+		if (m_session->m_pool) {
+			PyBatchResultArray results(args.size());
+			for (size_t i=0;i<args.size();i++) {
+				PyValue arg(args[i]);
+				callMethodResult(methodName,&arg).swap(results[i]);
+			}
+			return results;
+		}
+		PyGILLock lock;
+		std::ostringstream doingwhat;
+		doingwhat << "Calling method " << methodName << std::endl;
+		PyObject *pFunc = PyObject_GetAttrString(m_instance, methodName.c_str());
+		if (pFunc == NULL || !PyCallable_Check(pFunc)) {
+			Py_XDECREF(pFunc);
+			m_session->reportError(doingwhat.str());
+			return PyBatchResultArray();
+		}
+		PyBatchResultArray results = m_session->callBatch(pFunc,args,doingwhat.str());
+		Py_DECREF(pFunc);
+		return results;
+	}
+
+	/** \brief Delete the results of the calling thread.
+Method results are kept in the result buffer of the calling thread like function results, so this is
+the same as PySession::emptyResultBuffer().
+*/
+	void PyClass::emptyResultBuffer() {
+		m_session->emptyResultBuffer();
+	}
+}
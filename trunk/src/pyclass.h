@@ -1,30 +1,46 @@
-#ifndef PYCLASS_H
-#define PYCLASS_H
-
-#include "pyembdef.h"
-#include "pyvalue.h"
-
-#pragma warning( disable: 4251 )
-
-struct _object;
-typedef _object PyObject;
-
-namespace PyEmb {
-	class PySession;
-
-	class PYEMB_DECLSPEC PyClass {
-
-	public:
-		PyClass(PyObject *instance,PySession *session);
-		~PyClass();
-		PyValue *callMethod(const std::string &methodName, PyValue *args=NULL);
-		void emptyResultBuffer();
-
-	private:
-		PyObject *m_instance;
-		PySession *m_session;
-		PyValueArray m_resultbuffer;
-	};
-}
-
-#endif
+#ifndef PYCLASS_H
+#define PYCLASS_H
+
+#include "pyembdef.h"
+#include "pyvalue.h"
+#include "pysession.h"
+
+#pragma warning( disable: 4251 )
+
+struct _object;
+typedef _object PyObject;
+
+namespace PyEmb {
+	class PySession;
+	class PyMethodHandle;
+
+	typedef std::vector<PyMethodHandle*> PyMethodArray;
+
+	class PYEMB_DECLSPEC PyClass {
+		friend class PyMethodHandle;
+		friend class PySession;
+
+	public:
+		PyClass(PyObject *instance,PySession *session);
+		~PyClass();
+		PyValue *callMethod(const std::string &methodName, PyValue *args=NULL);
+		PyResult callMethodResult(const std::string &methodName, PyValue *args=NULL);
+		PyRef callMethodRef(const std::string &methodName, PyValue *args=NULL);
+		PyRef callMethodRef(const std::string &methodName, const PyRefList &args);
+		PyBatchResultArray callMethodBatch(const std::string &methodName, const PyValueList &args);
+		PyMethodHandle *resolveMethod(const std::string &methodName);
+		PyFuture *callMethodAsync(const std::string &methodName, PyValue *args=NULL,
+			PyFutureCallback callback=NULL, void *userData=NULL);
+		void emptyResultBuffer();
+
+	private:
+		PyValue *methodResult(PyObject *pValue, const std::string &methodName);
+		PyRef methodRef(const std::string &methodName, PyObject *pArgs);
+
+		PyObject *m_instance;
+		PySession *m_session;
+		PyMethodArray m_methods;
+	};
+}
+
+#endif
@@ -0,0 +1,193 @@
+#include <Python.h>
+#include "pyconverter.h"
+#include "pysession.h"
+#include "pyunicode.h"
+
+namespace PyEmb {
+	PyObject *PyConverter<long>::toPython(long value) {
+		return PyInt_FromLong(value);
+	}
+
+	bool PyConverter<long>::fromPython(PyObject *object, long &value) {
+		if (PyInt_Check(object)) {
+			value = PyInt_AS_LONG(object);
+			return true;
+		}
+		if (PyLong_Check(object)) {
+			value = PyLong_AsLong(object);
+			if (value == -1 && PyErr_Occurred()) {
+				PyErr_Clear();	// does not fit
+				return false;
+			}
+			return true;
+		}
+		return false;
+	}
+
+	PyObject *PyConverter<int>::toPython(int value) {
+		return PyInt_FromLong(value);
+	}
+
+	bool PyConverter<int>::fromPython(PyObject *object, int &value) {
+		long longValue;
+		if (!PyConverter<long>::fromPython(object,longValue) || longValue != (int) longValue) {
+			return false;
+		}
+		value = (int) longValue;
+		return true;
+	}
+
+	PyObject *PyConverter<double>::toPython(double value) {
+		return PyFloat_FromDouble(value);
+	}
+
+	/* Integers are accepted as well */
+	bool PyConverter<double>::fromPython(PyObject *object, double &value) {
+		if (PyFloat_Check(object)) {
+			value = PyFloat_AS_DOUBLE(object);
+			return true;
+		}
+		if (PyInt_Check(object)) {
+			value = (double) PyInt_AS_LONG(object);
+			return true;
+		}
+		if (PyLong_Check(object)) {
+			value = PyLong_AsDouble(object);
+			if (value == -1.0 && PyErr_Occurred()) {
+				PyErr_Clear();	// does not fit
+				return false;
+			}
+			return true;
+		}
+		return false;
+	}
+
+	PyObject *PyConverter<bool>::toPython(bool value) {
+		return PyBool_FromLong(value);
+	}
+
+	bool PyConverter<bool>::fromPython(PyObject *object, bool &value) {
+		if (PyInt_Check(object)) {
+			value = PyInt_AS_LONG(object) != 0;
+			return true;
+		}
+		return false;
+	}
+
+	PyObject *PyConverter<std::string>::toPython(const std::string &value) {
+		return PyString_FromStringAndSize(value.data(),value.size());
+	}
+
+	/* Unicode strings are encoded as UTF-8 */
+	bool PyConverter<std::string>::fromPython(PyObject *object, std::string &value) {
+		if (PyString_Check(object)) {
+			value.assign(PyString_AS_STRING(object),PyString_GET_SIZE(object));
+			return true;
+		}
+		if (PyUnicode_Check(object)) {
+			return pyUnicodeToUtf8(object,value);
+		}
+		return false;
+	}
+
+	PyObject *PyConverter<const char *>::toPython(const char *value) {
+		return PyString_FromString(value);
+	}
+
+	PyObject *PyConverter<PyValue>::toPython(const PyValue &value) {
+		return PySession::pyValueToPyObject(&value);
+	}
+
+	bool PyConverter<PyValue>::fromPython(PyObject *object, PyValue &value) {
+		PyValue converted(object);
+		value.swap(converted);
+		return true;
+	}
+
+	/* A null PyRef is passed as None */
+	PyObject *PyConverter<PyRef>::toPython(const PyRef &value) {
+		PyObject *object = value.isNull() ? Py_None : value.object();
+		Py_INCREF(object);
+		return object;
+	}
+
+	bool PyConverter<PyRef>::fromPython(PyObject *object, PyRef &value) {
+		PyRef ref(object);
+		value.swap(ref);
+		return true;
+	}
+
+	PyObject *PyConverter<PyStringView>::toPython(const PyStringView &value) {
+		return PyConverter<PyRef>::toPython(value.ref());
+	}
+
+	bool PyConverter<PyStringView>::fromPython(PyObject *object, PyStringView &value) {
+		PyStringView view((PyRef(object)));
+		value.swap(view);
+		return !value.isNull();
+	}
+
+	PyObject *pyNewTuple(size_t size) {
+		return PyTuple_New(size);
+	}
+
+	bool pySetTupleItem(PyObject *tuple, size_t index, PyObject *item) {
+		PyTuple_SET_ITEM(tuple,index,item);
+		return item != NULL;
+	}
+
+	PyObject *pyNewList(size_t size) {
+		return PyList_New(size);
+	}
+
+	bool pySetListItem(PyObject *list, size_t index, PyObject *item) {
+		PyList_SET_ITEM(list,index,item);
+		return item != NULL;
+	}
+
+	PyObject *pyNewDict() {
+		return PyDict_New();
+	}
+
+	bool pySetDictItem(PyObject *dict, PyObject *key, PyObject *item) {
+		// Fails on an unhashable key as well, fx. a list converted from a std::vector
+		bool ok = key && item && PyDict_SetItem(dict,key,item) == 0;
+		Py_XDECREF(key);
+		Py_XDECREF(item);
+		return ok;
+	}
+
+	bool pyDictNext(PyObject *dict, std::ptrdiff_t &pos, PyObject *&key, PyObject *&item) {
+		Py_ssize_t dictPos = pos;
+		bool more = PyDict_Next(dict,&dictPos,&key,&item) != 0;
+		pos = dictPos;
+		return more;
+	}
+
+	bool pyIsDict(PyObject *object) {
+		return PyDict_Check(object);
+	}
+
+	int pySequenceSize(PyObject *object) {
+		if (PyTuple_Check(object)) {
+			return PyTuple_GET_SIZE(object);
+		}
+		if (PyList_Check(object)) {
+			return PyList_GET_SIZE(object);
+		}
+		return -1;
+	}
+
+	PyObject *pySequenceItem(PyObject *sequence, int index) {
+		return PyTuple_Check(sequence) ? PyTuple_GET_ITEM(sequence,index) : PyList_GET_ITEM(sequence,index);
+	}
+
+	void pyDecRef(PyObject *object) {
+		Py_XDECREF(object);
+	}
+
+	PyObject *pyNone() {
+		Py_INCREF(Py_None);
+		return Py_None;
+	}
+}
@@ -0,0 +1,177 @@
+#ifndef PYCONVERTER_H
+#define PYCONVERTER_H
+
+#include "pyembdef.h"
+#include "pyvalue.h"
+#include "pyref.h"
+#include "pystringview.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <cstddef>
+
+struct _object;
+typedef _object PyObject;
+
+namespace PyEmb {
+	/** \struct PyConverter
+ PyConverter<T> converts between T and python objects for PySession::call(). The converter is chosen at
+ compile time, arguments go straight to python objects and results straight to T without a PyValue in
+ between. A type without a converter does not compile.
+ <br><br>
+ Converters are provided for long, int, double, bool, std::string, C strings (arguments only), PyValue,
+ PyRef, PyStringView, std::vector (python lists, results may also be tuples), std::map (dicts) and
+ std::pair (two element tuples). Other types, fx. structs, are supported by specializing PyConverter with the two functions
+ below, built from the converters of their members and the pyNew/pySet functions of this file:
+ <br><br>
+ static PyObject *toPython(const T &value);		// new reference, the GIL is held, NULL if it fails <br>
+ static bool fromPython(PyObject *object, T &value);	// false if object doesn't convert to T
+*/
+	template<class T> struct PyConverter;
+
+	template<> struct PYEMB_DECLSPEC PyConverter<long> {
+		static PyObject *toPython(long value);
+		static bool fromPython(PyObject *object, long &value);
+	};
+
+	template<> struct PYEMB_DECLSPEC PyConverter<int> {
+		static PyObject *toPython(int value);
+		static bool fromPython(PyObject *object, int &value);
+	};
+
+	template<> struct PYEMB_DECLSPEC PyConverter<double> {
+		static PyObject *toPython(double value);
+		static bool fromPython(PyObject *object, double &value);
+	};
+
+	template<> struct PYEMB_DECLSPEC PyConverter<bool> {
+		static PyObject *toPython(bool value);
+		static bool fromPython(PyObject *object, bool &value);
+	};
+
+	template<> struct PYEMB_DECLSPEC PyConverter<std::string> {
+		static PyObject *toPython(const std::string &value);
+		static bool fromPython(PyObject *object, std::string &value);
+	};
+
+	template<> struct PYEMB_DECLSPEC PyConverter<const char *> {
+		static PyObject *toPython(const char *value);
+	};
+
+	template<> struct PYEMB_DECLSPEC PyConverter<PyValue> {
+		static PyObject *toPython(const PyValue &value);
+		static bool fromPython(PyObject *object, PyValue &value);
+	};
+
+	template<> struct PYEMB_DECLSPEC PyConverter<PyRef> {
+		static PyObject *toPython(const PyRef &value);
+		static bool fromPython(PyObject *object, PyRef &value);
+	};
+
+	template<> struct PYEMB_DECLSPEC PyConverter<PyStringView> {
+		static PyObject *toPython(const PyStringView &value);
+		static bool fromPython(PyObject *object, PyStringView &value);
+	};
+
+	/* String literals are deduced as arrays */
+	template<size_t N> struct PyConverter<char[N]> {
+		static PyObject *toPython(const char *value) {return PyConverter<const char *>::toPython(value);}
+	};
+
+	template<> struct PyConverter<char *> {
+		static PyObject *toPython(const char *value) {return PyConverter<const char *>::toPython(value);}
+	};
+
+	/* Python object functions for converters, the GIL must be held. Items are stolen, like
+	   PyTuple_SetItem(), and returned items are borrowed. The set functions return false if
+	   an item is NULL, a failed conversion, or can't be stored */
+	PYEMB_DECLSPEC PyObject *pyNewTuple(size_t size);
+	PYEMB_DECLSPEC bool pySetTupleItem(PyObject *tuple, size_t index, PyObject *item);
+	PYEMB_DECLSPEC PyObject *pyNewList(size_t size);
+	PYEMB_DECLSPEC bool pySetListItem(PyObject *list, size_t index, PyObject *item);
+	PYEMB_DECLSPEC PyObject *pyNewDict();
+	PYEMB_DECLSPEC bool pySetDictItem(PyObject *dict, PyObject *key, PyObject *item);
+	PYEMB_DECLSPEC bool pyDictNext(PyObject *dict, std::ptrdiff_t &pos, PyObject *&key, PyObject *&item);
+	PYEMB_DECLSPEC bool pyIsDict(PyObject *object);
+	PYEMB_DECLSPEC int pySequenceSize(PyObject *object);	// -1 unless object is a list or tuple
+	PYEMB_DECLSPEC PyObject *pySequenceItem(PyObject *sequence, int index);
+	PYEMB_DECLSPEC void pyDecRef(PyObject *object);
+	PYEMB_DECLSPEC PyObject *pyNone();	// new reference
+
+	template<class T> struct PyConverter<std::vector<T> > {
+		static PyObject *toPython(const std::vector<T> &value) {
+			PyObject *list = pyNewList(value.size());
+			for (size_t i=0;list && i<value.size();i++) {
+				if (!pySetListItem(list,i,PyConverter<T>::toPython(value[i]))) {
+					pyDecRef(list);
+					list = NULL;
+				}
+			}
+			return list;
+		}
+
+		static bool fromPython(PyObject *object, std::vector<T> &value) {
+			int size = pySequenceSize(object);
+			if (size < 0) {
+				return false;
+			}
+			value.resize(size);
+			for (int i=0;i<size;i++) {
+				if (!PyConverter<T>::fromPython(pySequenceItem(object,i),value[i])) {
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	template<class K, class V> struct PyConverter<std::map<K,V> > {
+		static PyObject *toPython(const std::map<K,V> &value) {
+			PyObject *dict = pyNewDict();
+			typename std::map<K,V>::const_iterator it_val = value.begin();
+			for (; dict && it_val != value.end(); ++it_val) {
+				if (!pySetDictItem(dict,PyConverter<K>::toPython(it_val->first),PyConverter<V>::toPython(it_val->second))) {
+					pyDecRef(dict);
+					dict = NULL;
+				}
+			}
+			return dict;
+		}
+
+		static bool fromPython(PyObject *object, std::map<K,V> &value) {
+			if (!pyIsDict(object)) {
+				return false;
+			}
+			value.clear();
+			std::ptrdiff_t pos = 0;
+			PyObject *pKey, *pItem;
+			while (pyDictNext(object,pos,pKey,pItem)) {
+				K key;
+				if (!PyConverter<K>::fromPython(pKey,key) || !PyConverter<V>::fromPython(pItem,value[key])) {
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	template<class A, class B> struct PyConverter<std::pair<A,B> > {
+		static PyObject *toPython(const std::pair<A,B> &value) {
+			PyObject *tuple = pyNewTuple(2);
+			if (tuple && !(pySetTupleItem(tuple,0,PyConverter<A>::toPython(value.first))
+				&& pySetTupleItem(tuple,1,PyConverter<B>::toPython(value.second)))) {
+				pyDecRef(tuple);
+				tuple = NULL;
+			}
+			return tuple;
+		}
+
+		static bool fromPython(PyObject *object, std::pair<A,B> &value) {
+			return pySequenceSize(object) == 2
+				&& PyConverter<A>::fromPython(pySequenceItem(object,0),value.first)
+				&& PyConverter<B>::fromPython(pySequenceItem(object,1),value.second);
+		}
+	};
+}
+
+#endif
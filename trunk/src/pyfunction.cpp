@@ -0,0 +1,73 @@
+#include <Python.h>
+#include "pyfunction.h"
+#include "pysession.h"
+#include "pygil.h"
+
+#include <sstream>
+
+namespace PyEmb {
+	PyFunctionHandle::PyFunctionHandle(PyObject *function, PySession *session, const std::string &moduleName, const std::string &functionName) {
+		m_session = session;
+		m_function = function;
+		m_moduleName = moduleName;
+		m_functionName = functionName;
+		Py_INCREF(m_function);
+	}
+
+	PyFunctionHandle::~PyFunctionHandle() {
+		PyGILLock lock;
+		Py_DECREF(m_function);
+	}
+
+	/** \brief Call the resolved function
+Like PySession::callFunction() only without looking up the module and function.
+
+  @param args Arguments being passed (NULL meens no arguments)
+
+*/
+	PyValue *PyFunctionHandle::call(PyValue *args) {
+		PyGILLock lock;
+		PyObject *pArgs = m_session->pyValueToPyObject(args,true);
+		return callObj(pArgs);
+	}
+
+	/** \brief Call the resolved function and return the result by value
+See PySession::callFunctionResult().
+
+  @param args Arguments being passed (NULL meens no arguments)
+
+*/
+	PyResult PyFunctionHandle::callResult(PyValue *args) {
+		PyGILLock lock;
+		PyResult result;
+		std::ostringstream doingwhat;
+		doingwhat << "Calling function " << m_functionName << " in module " << m_moduleName << std::endl;
+		PyObject *pArgs = m_session->pyValueToPyObject(args,true);
+		m_session->callResult(m_function,pArgs,doingwhat.str(),result);
+		Py_XDECREF(pArgs);
+		return result;
+	}
+
+	/** \brief Call the resolved function
+Like PySession::callFunctionObj() the argument tuple is DECREF'ed by the call.
+
+  @param pArgs Arguments being passed (NULL meens no arguments)
+
+*/
+	PyValue *PyFunctionHandle::callObj(PyObject *pArgs) {
+		PyGILLock lock;
+		PyValue *result = NULL;
+		PyObject *pValue = PyObject_CallObject(m_function, pArgs);
+		if (pValue != NULL) {
+			result = m_session->storeResult(pValue);
+			Py_DECREF(pValue);
+		}
+		else {
+			std::ostringstream doingwhat;
+			doingwhat << "Calling function " << m_functionName << " in module " << m_moduleName << std::endl;
+			m_session->reportError(doingwhat.str());
+		}
+		Py_XDECREF(pArgs);
+		return result;
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef PYFUNCTION_H
+#define PYFUNCTION_H
+
+#include "pyembdef.h"
+#include "pyvalue.h"
+#include "pysession.h"
+
+#pragma warning( disable: 4251 )
+
+struct _object;
+typedef _object PyObject;
+
+namespace PyEmb {
+	class PySession;
+
+	/** \class PyFunctionHandle
+ A PyFunctionHandle is a resolved python callable obtained through PySession::resolveFunction().
+ The handle keeps a strong reference to the function object, so calling it skips the module lookup,
+ the module dictionary lookup and the callable check PySession::callFunction() performs on every call.
+ <br><br>
+ Handles are owned by the PySession which created them and may not be deleted by the calling instance.
+*/
+	class PYEMB_DECLSPEC PyFunctionHandle {
+
+	public:
+		PyFunctionHandle(PyObject *function, PySession *session, const std::string &moduleName, const std::string &functionName);
+		~PyFunctionHandle();
+		PyValue *call(PyValue *args=NULL);  // Garbage collection
+		PyValue *callObj(PyObject *args=NULL);  // Garbage collection
+		PyResult callResult(PyValue *args=NULL);
+		const std::string &moduleName() const {return m_moduleName;}
+		const std::string &functionName() const {return m_functionName;}
+
+	private:
+		PyObject *m_function;
+		PySession *m_session;
+		std::string m_moduleName;
+		std::string m_functionName;
+	};
+}
+
+#endif
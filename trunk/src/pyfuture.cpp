@@ -0,0 +1,66 @@
+#include <Python.h>
+#include <pythread.h>
+#include "pyfuture.h"
+
+namespace PyEmb {
+	PyFuture::PyFuture(PyFutureCallback callback, void *userData) {
+		m_ok = false;
+		m_instance = NULL;
+		m_callback = callback;
+		m_userData = userData;
+		// m_done is held until the result is set, m_finished until the callback has returned
+		m_done = PyThread_allocate_lock();
+		m_finished = PyThread_allocate_lock();
+		PyThread_acquire_lock(m_done,WAIT_LOCK);
+		PyThread_acquire_lock(m_finished,WAIT_LOCK);
+	}
+
+	PyFuture::~PyFuture() {
+		PyThread_acquire_lock(m_finished,WAIT_LOCK);
+		PyThread_release_lock(m_finished);
+		PyThread_free_lock(m_done);
+		PyThread_free_lock(m_finished);
+	}
+
+	/** \brief Test whether the call has completed, without waiting */
+	bool PyFuture::ready() {
+		if (PyThread_acquire_lock(m_done,NOWAIT_LOCK)) {
+			PyThread_release_lock(m_done);
+			return true;
+		}
+		return false;
+	}
+
+	/** \brief Wait for the call to complete */
+	void PyFuture::wait() {
+		PyThread_acquire_lock(m_done,WAIT_LOCK);
+		PyThread_release_lock(m_done);
+	}
+
+	/** \brief Wait for the call and test whether it succeeded.
+If it didn't, error() describes the python exception.
+*/
+	bool PyFuture::ok() {
+		wait();
+		return m_ok;
+	}
+
+	/** \brief Wait for the call and retrieve the returned value */
+	const PyValue &PyFuture::value() {
+		wait();
+		return m_value;
+	}
+
+	/** \brief Wait for the call and retrieve the python exception it raised */
+	const PyError &PyFuture::error() {
+		wait();
+		return m_error;
+	}
+
+	void PyFuture::complete() {
+		PyThread_release_lock(m_done);
+		if (m_callback)
+			m_callback(this,m_userData);
+		PyThread_release_lock(m_finished);
+	}
+}
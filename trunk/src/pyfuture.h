@@ -0,0 +1,58 @@
+#ifndef PYFUTURE_H
+#define PYFUTURE_H
+
+#include "pyembdef.h"
+#include "pyerror.h"
+#include "pyvalue.h"
+
+#pragma warning( disable: 4251 )
+
+typedef void *PyThread_type_lock;
+
+namespace PyEmb {
+	class PyFuture;
+	class PyClass;
+
+	/** Called on the interpreter thread when an asynchronous call completes */
+	typedef void (*PyFutureCallback)(PyFuture *future, void *userData);
+
+	/** \class PyFuture
+ A PyFuture holds the result of a call made through PySession::callFunctionAsync() or
+ PyClass::callMethodAsync(). The call runs on the session's interpreter thread, value() and error()
+ wait for it to complete.
+ <br><br>
+ Futures are owned by the PySession and deleted by PySession::emptyResultBuffer() in the thread
+ which made the call, so they may not be deleted by the calling instance.
+*/
+	class PYEMB_DECLSPEC PyFuture {
+		friend class PySession;
+		friend class PyInterpreterPool;
+		friend class PyProcessPool;
+		friend class PyClass;
+
+	public:
+		PyFuture(PyFutureCallback callback=NULL, void *userData=NULL);
+		~PyFuture();
+		bool ready();
+		void wait();
+		bool ok();
+		const PyValue &value();
+		const PyError &error();
+
+	private:
+		PyFuture(const PyFuture &);
+		PyFuture &operator=(const PyFuture &);
+		void complete();
+
+		PyValue m_value;
+		PyError m_error;
+		bool m_ok;
+		PyClass *m_instance;
+		PyFutureCallback m_callback;
+		void *m_userData;
+		PyThread_type_lock m_done;
+		PyThread_type_lock m_finished;
+	};
+}
+
+#endif
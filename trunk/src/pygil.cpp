@@ -0,0 +1,12 @@
+#include <Python.h>
+#include "pygil.h"
+
+namespace PyEmb {
+	PyGILLock::PyGILLock() {
+		m_state = (int) PyGILState_Ensure();
+	}
+
+	PyGILLock::~PyGILLock() {
+		PyGILState_Release((PyGILState_STATE) m_state);
+	}
+}
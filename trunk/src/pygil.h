@@ -0,0 +1,28 @@
+#ifndef PYGIL_H
+#define PYGIL_H
+
+#include "pyembdef.h"
+
+namespace PyEmb {
+	/** \class PyGILLock
+ PyGILLock acquires the python global interpreter lock (GIL) for the calling thread on construction
+ and releases it on destruction. PySession releases the GIL while it is idle and every PySession,
+ PyClass and handle method acquires it for the duration of the call, so this is only needed when
+ working with PyObject's directly - fx. the result of PySession::pyValueToPyObject().
+ <br><br>
+ Locks may be nested within the same thread.
+*/
+	class PYEMB_DECLSPEC PyGILLock {
+
+	public:
+		PyGILLock();
+		~PyGILLock();
+
+	private:
+		PyGILLock(const PyGILLock &);
+		PyGILLock &operator=(const PyGILLock &);
+		int m_state;
+	};
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include <Python.h>
+#include "pyhostmodule.h"
+
+#include <exception>
+
+namespace PyEmb {
+	/* Name of the capsules passing the functions to callHost() */
+	static const char *capsuleName = "pyemb.hostfunction";
+
+	void PyHostFunction::argumentError(int index) {
+		PyErr_Format(PyExc_TypeError,"%s() argument %d has the wrong type",m_name.c_str(),index+1);
+	}
+
+	/* Python calls every host function through this, with the function in a capsule as self */
+	static PyObject *callHost(PyObject *self, PyObject *args) {
+		PyHostFunction *function = (PyHostFunction *) PyCapsule_GetPointer(self,capsuleName);
+		if (!function)
+			return NULL;
+		if (PyTuple_GET_SIZE(args) != function->arity()) {
+			PyErr_Format(PyExc_TypeError,"%s() takes %d arguments (%d given)",
+				function->name().c_str(),function->arity(),(int) PyTuple_GET_SIZE(args));
+			return NULL;
+		}
+		// Exceptions may not pass through python
+		try {
+			return function->call(args);
+		}
+		catch (std::exception &e) {
+			PyErr_SetString(PyExc_RuntimeError,e.what());
+		}
+		catch (...) {
+			PyErr_SetString(PyExc_RuntimeError,"C++ exception");
+		}
+		return NULL;
+	}
+
+	/** \brief Constructor
+
+  @param name Name python imports the module by
+
+*/
+	PyHostModule::PyHostModule(const std::string &name) {
+		m_name = name;
+	}
+
+	PyHostModule::~PyHostModule() {
+		std::vector<PyHostFunction*>::iterator it_func = m_functions.begin();
+		for (; it_func != m_functions.end(); ++it_func) {
+			delete *it_func;
+		}
+		std::vector<PyMethodDef*>::iterator it_meth = m_methods.begin();
+		for (; it_meth != m_methods.end(); ++it_meth) {
+			delete *it_meth;
+		}
+	}
+
+	/* Add the functions to the module of the current interpreter, creating it if it doesn't exist.
+	   Call with the GIL held. Returns false with a python exception set if it fails */
+	bool PyHostModule::install() {
+		PyObject *module = PyImport_AddModule(m_name.c_str());
+		/* module: Borrowed reference */
+		if (!module)
+			return false;
+		for (size_t i=m_methods.size();i<m_functions.size();i++) {
+			PyMethodDef *method = new PyMethodDef;
+			method->ml_name = m_functions[i]->name().c_str();
+			method->ml_meth = callHost;
+			method->ml_flags = METH_VARARGS;
+			method->ml_doc = NULL;
+			m_methods.push_back(method);
+		}
+		PyObject *pName = PyString_FromString(m_name.c_str());
+		bool ok = pName != NULL;
+		for (size_t i=0;ok && i<m_functions.size();i++) {
+			PyObject *self = PyCapsule_New(m_functions[i],capsuleName,NULL);
+			PyObject *pFunc = self ? PyCFunction_NewEx(m_methods[i],self,pName) : NULL;
+			Py_XDECREF(self);
+			// PyModule_AddObject() steals pFunc
+			ok = pFunc && PyModule_AddObject(module,m_methods[i]->ml_name,pFunc) == 0;
+		}
+		Py_XDECREF(pName);
+		return ok;
+	}
+}
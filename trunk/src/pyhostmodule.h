@@ -0,0 +1,263 @@
+#ifndef PYHOSTMODULE_H
+#define PYHOSTMODULE_H
+
+#include "pyembdef.h"
+#include "pyconverter.h"
+#include <vector>
+#include <string>
+
+#pragma warning( disable: 4251 )
+
+struct PyMethodDef;
+
+namespace PyEmb {
+	/* Type an argument is converted to, without const and reference */
+	template<class T> struct PyHostArgument {typedef T type;};
+	template<class T> struct PyHostArgument<const T> {typedef T type;};
+	template<class T> struct PyHostArgument<const T &> {typedef T type;};
+	template<class T> struct PyHostArgument<T &> {typedef T type;};
+
+	/** \class PyHostFunction
+ A C++ function called from python, see PyHostModule. call() converts the python arguments with PyConverter
+ and the result back, there is no PyValue in between.
+*/
+	class PYEMB_DECLSPEC PyHostFunction {
+
+	public:
+		PyHostFunction(const std::string &name, int arity) : m_name(name), m_arity(arity) {}
+		virtual ~PyHostFunction() {}
+		const std::string &name() const {return m_name;}
+		int arity() const {return m_arity;}
+		/* Called with the GIL held and a tuple of arity() arguments. Returns a new reference, or NULL with
+		   a python exception set */
+		virtual PyObject *call(PyObject *args) = 0;
+
+	protected:
+		/* Convert argument index of args, sets a TypeError if it doesn't convert */
+		template<class T> bool argument(PyObject *args, int index, T &value) {
+			if (PyConverter<T>::fromPython(pySequenceItem(args,index),value))
+				return true;
+			argumentError(index);
+			return false;
+		}
+		void argumentError(int index);
+
+	private:
+		std::string m_name;
+		int m_arity;
+	};
+
+	/* Calls a function and converts its result, None for void functions */
+	template<class R> struct PyHostResult {
+		typedef typename PyHostArgument<R>::type Type;
+		template<class F> static PyObject *call(F function) {return PyConverter<Type>::toPython(function());}
+		template<class F, class A1> static PyObject *call(F function, A1 &a1) {return PyConverter<Type>::toPython(function(a1));}
+		template<class F, class A1, class A2> static PyObject *call(F function, A1 &a1, A2 &a2) {return PyConverter<Type>::toPython(function(a1,a2));}
+		template<class F, class A1, class A2, class A3> static PyObject *call(F function, A1 &a1, A2 &a2, A3 &a3) {return PyConverter<Type>::toPython(function(a1,a2,a3));}
+		template<class F, class A1, class A2, class A3, class A4> static PyObject *call(F function, A1 &a1, A2 &a2, A3 &a3, A4 &a4) {return PyConverter<Type>::toPython(function(a1,a2,a3,a4));}
+		template<class F, class A1, class A2, class A3, class A4, class A5> static PyObject *call(F function, A1 &a1, A2 &a2, A3 &a3, A4 &a4, A5 &a5) {return PyConverter<Type>::toPython(function(a1,a2,a3,a4,a5));}
+	};
+
+	template<> struct PyHostResult<void> {
+		template<class F> static PyObject *call(F function) {function(); return pyNone();}
+		template<class F, class A1> static PyObject *call(F function, A1 &a1) {function(a1); return pyNone();}
+		template<class F, class A1, class A2> static PyObject *call(F function, A1 &a1, A2 &a2) {function(a1,a2); return pyNone();}
+		template<class F, class A1, class A2, class A3> static PyObject *call(F function, A1 &a1, A2 &a2, A3 &a3) {function(a1,a2,a3); return pyNone();}
+		template<class F, class A1, class A2, class A3, class A4> static PyObject *call(F function, A1 &a1, A2 &a2, A3 &a3, A4 &a4) {function(a1,a2,a3,a4); return pyNone();}
+		template<class F, class A1, class A2, class A3, class A4, class A5> static PyObject *call(F function, A1 &a1, A2 &a2, A3 &a3, A4 &a4, A5 &a5) {function(a1,a2,a3,a4,a5); return pyNone();}
+	};
+
+	template<class R> class PyHostFunction0 : public PyHostFunction {
+
+	public:
+		typedef R (*Function)();
+		PyHostFunction0(const std::string &name, Function function) : PyHostFunction(name,0), m_function(function) {}
+		PyObject *call(PyObject *args) {
+			return PyHostResult<R>::call(m_function);
+		}
+
+	private:
+		Function m_function;
+	};
+
+	template<class R, class A1> class PyHostFunction1 : public PyHostFunction {
+
+	public:
+		typedef R (*Function)(A1);
+		PyHostFunction1(const std::string &name, Function function) : PyHostFunction(name,1), m_function(function) {}
+		PyObject *call(PyObject *args) {
+			typename PyHostArgument<A1>::type a1;
+			if (!argument(args,0,a1))
+				return NULL;
+			return PyHostResult<R>::call(m_function, a1);
+		}
+
+	private:
+		Function m_function;
+	};
+
+	template<class R, class A1, class A2> class PyHostFunction2 : public PyHostFunction {
+
+	public:
+		typedef R (*Function)(A1, A2);
+		PyHostFunction2(const std::string &name, Function function) : PyHostFunction(name,2), m_function(function) {}
+		PyObject *call(PyObject *args) {
+			typename PyHostArgument<A1>::type a1;
+			if (!argument(args,0,a1))
+				return NULL;
+			typename PyHostArgument<A2>::type a2;
+			if (!argument(args,1,a2))
+				return NULL;
+			return PyHostResult<R>::call(m_function, a1, a2);
+		}
+
+	private:
+		Function m_function;
+	};
+
+	template<class R, class A1, class A2, class A3> class PyHostFunction3 : public PyHostFunction {
+
+	public:
+		typedef R (*Function)(A1, A2, A3);
+		PyHostFunction3(const std::string &name, Function function) : PyHostFunction(name,3), m_function(function) {}
+		PyObject *call(PyObject *args) {
+			typename PyHostArgument<A1>::type a1;
+			if (!argument(args,0,a1))
+				return NULL;
+			typename PyHostArgument<A2>::type a2;
+			if (!argument(args,1,a2))
+				return NULL;
+			typename PyHostArgument<A3>::type a3;
+			if (!argument(args,2,a3))
+				return NULL;
+			return PyHostResult<R>::call(m_function, a1, a2, a3);
+		}
+
+	private:
+		Function m_function;
+	};
+
+	template<class R, class A1, class A2, class A3, class A4> class PyHostFunction4 : public PyHostFunction {
+
+	public:
+		typedef R (*Function)(A1, A2, A3, A4);
+		PyHostFunction4(const std::string &name, Function function) : PyHostFunction(name,4), m_function(function) {}
+		PyObject *call(PyObject *args) {
+			typename PyHostArgument<A1>::type a1;
+			if (!argument(args,0,a1))
+				return NULL;
+			typename PyHostArgument<A2>::type a2;
+			if (!argument(args,1,a2))
+				return NULL;
+			typename PyHostArgument<A3>::type a3;
+			if (!argument(args,2,a3))
+				return NULL;
+			typename PyHostArgument<A4>::type a4;
+			if (!argument(args,3,a4))
+				return NULL;
+			return PyHostResult<R>::call(m_function, a1, a2, a3, a4);
+		}
+
+	private:
+		Function m_function;
+	};
+
+	template<class R, class A1, class A2, class A3, class A4, class A5> class PyHostFunction5 : public PyHostFunction {
+
+	public:
+		typedef R (*Function)(A1, A2, A3, A4, A5);
+		PyHostFunction5(const std::string &name, Function function) : PyHostFunction(name,5), m_function(function) {}
+		PyObject *call(PyObject *args) {
+			typename PyHostArgument<A1>::type a1;
+			if (!argument(args,0,a1))
+				return NULL;
+			typename PyHostArgument<A2>::type a2;
+			if (!argument(args,1,a2))
+				return NULL;
+			typename PyHostArgument<A3>::type a3;
+			if (!argument(args,2,a3))
+				return NULL;
+			typename PyHostArgument<A4>::type a4;
+			if (!argument(args,3,a4))
+				return NULL;
+			typename PyHostArgument<A5>::type a5;
+			if (!argument(args,4,a5))
+				return NULL;
+			return PyHostResult<R>::call(m_function, a1, a2, a3, a4, a5);
+		}
+
+	private:
+		Function m_function;
+	};
+
+	/** \class PyHostModule
+ A PyHostModule exposes C++ functions to python as a module, so scripts can call back into the host
+ application. Functions of up to five arguments are added with addFunction(), their argument and result
+ types are converted by PyConverter, chosen at compile time - a call from python converts its arguments
+ straight to the C++ types, there is no PyValue tree or format string. Install the module in a session
+ with PySession::addModule(), scripts then import it like any other module:
+ <br><br>
+ double price(const std::string &item, long quantity); <br>
+ <br>
+ PyHostModule host("host"); <br>
+ host.addFunction("price",price); <br>
+ session.addModule(&host); <br>
+ <br>
+ # python <br>
+ import host <br>
+ total = host.price('apple',3) <br>
+ <br>
+ The functions run on the thread of the python call with the GIL held. An argument which doesn't convert
+ raises a TypeError, and a C++ exception thrown by a function is raised as a RuntimeError. The module must
+ exist as long as the sessions it is added to.
+*/
+	class PYEMB_DECLSPEC PyHostModule {
+		friend class PySession;
+
+	public:
+		PyHostModule(const std::string &name);
+		~PyHostModule();
+		const std::string &name() const {return m_name;}
+
+		template<class R>
+		void addFunction(const std::string &name, R (*function)()) {
+			m_functions.push_back(new PyHostFunction0<R>(name,function));
+		}
+
+		template<class R, class A1>
+		void addFunction(const std::string &name, R (*function)(A1)) {
+			m_functions.push_back(new PyHostFunction1<R, A1>(name,function));
+		}
+
+		template<class R, class A1, class A2>
+		void addFunction(const std::string &name, R (*function)(A1, A2)) {
+			m_functions.push_back(new PyHostFunction2<R, A1, A2>(name,function));
+		}
+
+		template<class R, class A1, class A2, class A3>
+		void addFunction(const std::string &name, R (*function)(A1, A2, A3)) {
+			m_functions.push_back(new PyHostFunction3<R, A1, A2, A3>(name,function));
+		}
+
+		template<class R, class A1, class A2, class A3, class A4>
+		void addFunction(const std::string &name, R (*function)(A1, A2, A3, A4)) {
+			m_functions.push_back(new PyHostFunction4<R, A1, A2, A3, A4>(name,function));
+		}
+
+		template<class R, class A1, class A2, class A3, class A4, class A5>
+		void addFunction(const std::string &name, R (*function)(A1, A2, A3, A4, A5)) {
+			m_functions.push_back(new PyHostFunction5<R, A1, A2, A3, A4, A5>(name,function));
+		}
+
+	private:
+		PyHostModule(const PyHostModule &);
+		PyHostModule &operator=(const PyHostModule &);
+		bool install();
+
+		std::string m_name;
+		std::vector<PyHostFunction*> m_functions;
+		std::vector<PyMethodDef*> m_methods;
+	};
+}
+
+#endif
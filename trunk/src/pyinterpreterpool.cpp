@@ -0,0 +1,194 @@
+#include <Python.h>
+#include <pythread.h>
+#include "pyinterpreterpool.h"
+#include "pycallqueue.h"
+#include "pyfuture.h"
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+namespace PyEmb {
+	/* The turn of the calling thread, counters are incremented by any host thread */
+	static unsigned long nextTurn(volatile long &counter) {
+#ifdef WIN32
+		return (unsigned long) InterlockedIncrement(&counter) - 1;
+#else
+		return (unsigned long) __sync_fetch_and_add(&counter,1);
+#endif
+	}
+
+	/** \brief Constructor
+
+  @param interpreters Number of sub interpreters (at least one)
+  @param autoAlert Automatically display python exceptions
+
+*/
+	PyInterpreterPool::PyInterpreterPool(int interpreters, bool autoAlert) {
+		m_nextInstance = 0;
+		m_nextWorker = 0;
+		m_main = new PySession(autoAlert);
+		if (interpreters < 1)
+			interpreters = 1;
+		for (int i=0;i<interpreters;i++) {
+			PySession *worker = new PySession(this,autoAlert);
+			m_workers.push_back(worker);
+			m_queues.push_back(worker->m_callQueue);
+		}
+		for (size_t i=0;i<m_queues.size();i++) {
+			m_queues[i]->setSiblings(&m_queues);
+		}
+	}
+
+	/** \brief Destructor */
+	PyInterpreterPool::~PyInterpreterPool() {
+		// No interpreter thread may be stealing from a queue being deleted
+		PyCallQueueArray::iterator it_queue = m_queues.begin();
+		for (; it_queue != m_queues.end(); ++it_queue) {
+			(*it_queue)->stop();
+		}
+		PySessionArray::iterator it_worker = m_workers.begin();
+		for (; it_worker != m_workers.end(); ++it_worker) {
+			delete *it_worker;
+		}
+		delete m_main;
+	}
+
+	/** \brief Number of interpreters in the pool */
+	int PyInterpreterPool::size() const {
+		return m_workers.size();
+	}
+
+	/** \brief Add an absolute path to sys.path of every interpreter.
+See PySession::addToPyPath()
+*/
+	void PyInterpreterPool::addToPyPath(const std::string &path) {
+		broadcast(PyAsyncCall::PathAppend,path);
+	}
+
+	/** \brief Import a python module in every interpreter.
+See PySession::importModule()
+
+Returns false if the import failed in any of the interpreters.
+*/
+	bool PyInterpreterPool::importModule(const std::string &moduleName) {
+		return broadcast(PyAsyncCall::ModuleImport,moduleName);
+	}
+
+	/** \brief Create a new instance of a class in one of the interpreters.
+Instances are spread over the interpreters in turn. See PySession::newInstance()
+*/
+	PyClass *PyInterpreterPool::newInstance(const std::string &moduleName, const std::string &className, PyValue *args) {
+		PySession *worker = m_workers[nextTurn(m_nextInstance) % m_workers.size()];
+		PyAsyncCall *call = new PyAsyncCall;
+		call->kind = PyAsyncCall::InstanceCreation;
+		call->moduleName = moduleName;
+		call->functionName = className;
+		call->instance = NULL;
+		PyFuture *future = worker->queueCall(call,args,NULL,NULL);
+		if (!future->ok()) {
+			*lastError() = future->error();
+			return NULL;
+		}
+		return future->m_instance;
+	}
+
+	/** \brief Call a python function in one of the interpreters and wait for the result.
+See PySession::callFunction()
+*/
+	PyValue *PyInterpreterPool::callFunction(const std::string &moduleName, const std::string &functionName, PyValue *args) {
+		PyFuture *future = callFunctionAsync(moduleName,functionName,args);
+		if (!future->ok()) {
+			*lastError() = future->error();
+			return NULL;
+		}
+		return &future->m_value;
+	}
+
+	/** \brief Queue a python function call for one of the interpreters.
+See PySession::callFunctionAsync()
+*/
+	PyFuture *PyInterpreterPool::callFunctionAsync(const std::string &moduleName, const std::string &functionName, PyValue *args,
+		PyFutureCallback callback, void *userData) {
+		return leastLoaded()->callFunctionAsync(moduleName,functionName,args,callback,userData);
+	}
+
+	/** \brief Delete the results of the calling thread in all interpreters.
+See PySession::emptyResultBuffer()
+*/
+	void PyInterpreterPool::emptyResultBuffer() {
+		PySessionArray::iterator it_worker = m_workers.begin();
+		for (; it_worker != m_workers.end(); ++it_worker) {
+			(*it_worker)->emptyResultBuffer();
+		}
+		m_main->emptyResultBuffer();
+	}
+
+	/** \brief Retrieve a pointer to the last python exception (error) which has occured
+in a call made by the calling thread.
+*/
+	PyError *PyInterpreterPool::lastError() {
+		return m_main->lastError();
+	}
+
+	/** \brief Counters of all interpreter queues added up.
+maxDepth and maxWait are the largest of any queue.
+*/
+	PyAsyncStats PyInterpreterPool::asyncStats() {
+		PyAsyncStats total;
+		PySessionArray::iterator it_worker = m_workers.begin();
+		for (; it_worker != m_workers.end(); ++it_worker) {
+			PyAsyncStats stats = (*it_worker)->asyncStats();
+			total.queued += stats.queued;
+			total.completed += stats.completed;
+			total.stolen += stats.stolen;
+			total.depth += stats.depth;
+			total.totalWait += stats.totalWait;
+			if (stats.maxDepth > total.maxDepth)
+				total.maxDepth = stats.maxDepth;
+			if (stats.maxWait > total.maxWait)
+				total.maxWait = stats.maxWait;
+		}
+		return total;
+	}
+
+	/* Run the same call in every interpreter and wait for all of them */
+	bool PyInterpreterPool::broadcast(int kind, const std::string &argument) {
+		PyFutureArray futures;
+		PySessionArray::iterator it_worker = m_workers.begin();
+		for (; it_worker != m_workers.end(); ++it_worker) {
+			PyAsyncCall *call = new PyAsyncCall;
+			call->kind = (PyAsyncCall::Kind) kind;
+			call->moduleName = argument;
+			call->instance = NULL;
+			futures.push_back((*it_worker)->queueCall(call,NULL,NULL,NULL));
+		}
+		bool ok = true;
+		PyFutureArray::iterator it_fut = futures.begin();
+		for (; it_fut != futures.end(); ++it_fut) {
+			if (!(*it_fut)->ok()) {
+				*lastError() = (*it_fut)->error();
+				ok = false;
+			}
+		}
+		return ok;
+	}
+
+	/* The interpreter with the fewest calls waiting. The search starts at the next
+	   interpreter in turn, so idle interpreters share the calls */
+	PySession *PyInterpreterPool::leastLoaded() {
+		int count = m_workers.size();
+		int start = nextTurn(m_nextWorker) % count;
+		int best = start;
+		int depth = m_queues[start]->depth();
+		for (int i=1;i<count && depth > 0;i++) {
+			int index = (start+i) % count;
+			int workerDepth = m_queues[index]->depth();
+			if (workerDepth < depth) {
+				best = index;
+				depth = workerDepth;
+			}
+		}
+		return m_workers[best];
+	}
+}
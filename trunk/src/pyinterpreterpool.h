@@ -0,0 +1,68 @@
+#ifndef PYINTERPRETERPOOL_H
+#define PYINTERPRETERPOOL_H
+
+#include "pyembdef.h"
+#include "pysession.h"
+
+#include <vector>
+#include <string>
+
+#pragma warning( disable: 4251 )
+
+namespace PyEmb {
+	class PyClass;
+	class PyCallQueue;
+
+	typedef std::vector<PySession*> PySessionArray;
+
+	/** \class PyInterpreterPool
+ A PyInterpreterPool runs python calls on a number of isolated python sub interpreters, each with
+ its own thread, sys.path and set of imported modules. Apart from the constructor it is used like a
+ PySession - import modules, call functions and create class instances.
+ <br><br>
+ SCHEDULING <br>
+ Function calls are queued for the interpreter with the fewest calls waiting, and an interpreter
+ running out of calls steals function calls queued for the others. Modules are imported and sys.path
+ is changed in all interpreters. A class instance lives in one interpreter and all calls of its
+ methods run there - use PyClass::callMethod() and PyClass::callMethodAsync() on instances
+ created by the pool.
+ <br><br>
+ Note that python 2 sub interpreters share the global interpreter lock, so python code of different
+ interpreters is still executed one at a time. Calls spending their time in code releasing the GIL
+ (I/O, sleeping, C extensions) run concurrently.
+ <br><br>
+ GARBAGE COLLECTION <br>
+ Returned pointers are owned by the pool like they are by PySession and freed by emptyResultBuffer()
+ and on destruction.
+*/
+	class PYEMB_DECLSPEC PyInterpreterPool {
+
+	public:
+		PyInterpreterPool(int interpreters, bool autoAlert=true);
+		~PyInterpreterPool();
+		int size() const;
+		void addToPyPath(const std::string &path);
+		bool importModule(const std::string &moduleName);
+		PyClass *newInstance(const std::string &moduleName, const std::string &className, PyValue *args=NULL); // Garbage collection
+		PyValue *callFunction(const std::string &moduleName, const std::string &functionName, PyValue *args=NULL); // Garbage collection
+		PyFuture *callFunctionAsync(const std::string &moduleName, const std::string &functionName, PyValue *args=NULL,
+			PyFutureCallback callback=NULL, void *userData=NULL); // Garbage collection
+		void emptyResultBuffer();
+		PyError *lastError();
+		PyAsyncStats asyncStats();
+
+	private:
+		PyInterpreterPool(const PyInterpreterPool &);
+		PyInterpreterPool &operator=(const PyInterpreterPool &);
+		bool broadcast(int kind, const std::string &argument);
+		PySession *leastLoaded();
+
+		PySession *m_main;
+		PySessionArray m_workers;
+		PyCallQueueArray m_queues;
+		volatile long m_nextInstance;
+		volatile long m_nextWorker;
+	};
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include <Python.h>
+#include "pyiterator.h"
+#include "pysession.h"
+#include "pygil.h"
+
+namespace PyEmb {
+	/** \brief The end iterator */
+	PyIterator::PyIterator() {
+		m_session = NULL;
+		m_converted = false;
+	}
+
+	/** \brief Iterate the object of iterable, a null PyRef is empty
+
+  @param session Session reporting python exceptions
+  @param iterable Object to iterate
+
+*/
+	PyIterator::PyIterator(PySession *session, const PyRef &iterable) {
+		m_session = session;
+		m_converted = false;
+		if (iterable.isNull())
+			return;
+		PyGILLock lock;
+		m_iterator = PyRef::steal(PyObject_GetIter(iterable.object()));
+		if (m_iterator.isNull()) {
+			m_session->reportError("Iterating\n");
+			return;
+		}
+		next();
+	}
+
+	/** \brief The current item, converted when it is first read. None at the end */
+	const PyValue &PyIterator::operator*() const {
+		if (!m_converted) {
+			PyValue value = m_item.value(m_session && m_session->lazyConversionEnabled());
+			m_value.swap(value);
+			m_converted = true;
+		}
+		return m_value;
+	}
+
+	PyIterator &PyIterator::operator++() {
+		next();
+		return *this;
+	}
+
+	PyIterator PyIterator::operator++(int) {
+		PyIterator previous(*this);
+		next();
+		return previous;
+	}
+
+	/** \brief Iterators are equal at the same item of the same iterable, or both at the end */
+	bool PyIterator::operator==(const PyIterator &other) const {
+		return m_item.object() == other.m_item.object() && m_iterator.object() == other.m_iterator.object();
+	}
+
+	/* Pull the next item. The python iterator is released at the end */
+	void PyIterator::next() {
+		PyGILLock lock;
+		m_converted = false;
+		m_value = PyValue();
+		if (m_iterator.isNull()) {
+			PyRef().swap(m_item);
+			return;
+		}
+		PyRef item = PyRef::steal(PyIter_Next(m_iterator.object()));
+		m_item.swap(item);
+		if (m_item.isNull()) {
+			if (PyErr_Occurred())
+				m_session->reportError("Iterating\n");
+			m_iterator = PyRef();
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#ifndef PYITERATOR_H
+#define PYITERATOR_H
+
+#include "pyembdef.h"
+#include "pyvalue.h"
+#include "pyref.h"
+#include <iterator>
+#include <cstddef>
+
+#pragma warning( disable: 4251 )
+
+namespace PyEmb {
+	class PySession;
+
+	/** \class PyIterator
+ A PyIterator is an input iterator over a python iterable - a generator, a list or anything else python
+ can iterate. Items are pulled one at a time as the iterator is advanced and converted to a PyValue when
+ they are first read, so a stream of results of any length is consumed in constant memory. Get one from
+ PySession::callFunctionIter(), or construct it from a PyRef, fx. the result of PyClass::callMethodRef().
+ The end iterator is a default constructed PyIterator:
+ <br><br>
+ PyIterator it = session.callFunctionIter("orders","rows"); <br>
+ for (; it != PyIterator(); ++it) <br>
+   total += it->valueAsDict().value("amount").valueAsDouble(); <br>
+ <br>
+ Copies share the position of the python iterator, like any input iterator. A python exception ends the
+ iteration and is reported through PySession::lastError(). Items are converted lazily if the session
+ converts lazily, see PySession::setLazyConversionEnabled(). Advancing and releasing a PyIterator acquires
+ the GIL, and it must be released before the PySession is destroyed.
+*/
+	class PYEMB_DECLSPEC PyIterator {
+
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef PyValue value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const PyValue *pointer;
+		typedef const PyValue &reference;
+
+		PyIterator();
+		PyIterator(PySession *session, const PyRef &iterable);
+		const PyValue &operator*() const;
+		const PyValue *operator->() const {return &**this;}
+		PyIterator &operator++();
+		PyIterator operator++(int);
+		bool operator==(const PyIterator &other) const;
+		bool operator!=(const PyIterator &other) const {return !(*this == other);}
+		const PyRef &item() const {return m_item;}
+
+	private:
+		void next();
+
+		PySession *m_session;
+		PyRef m_iterator;
+		PyRef m_item;			// null at the end
+		mutable PyValue m_value;
+		mutable bool m_converted;	// m_value holds m_item
+	};
+}
+
+#endif
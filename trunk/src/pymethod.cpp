@@ -0,0 +1,144 @@
+#include <Python.h>
+#include "pymethod.h"
+#include "pyclass.h"
+#include "pysession.h"
+#include "pygil.h"
+
+namespace PyEmb {
+	/* Look name up in an old style class and its bases, like getattr does */
+	static PyObject *classLookup(PyObject *cls, PyObject *name) {
+		PyClassObject *pClass = (PyClassObject *) cls;
+		PyObject *value = PyDict_GetItem(pClass->cl_dict, name);
+		if (value)
+			return value;
+		for (Py_ssize_t i=0;i<PyTuple_Size(pClass->cl_bases);i++) {
+			value = classLookup(PyTuple_GetItem(pClass->cl_bases,i), name);
+			if (value)
+				return value;
+		}
+		return NULL;
+	}
+
+	PyMethodHandle::PyMethodHandle(PyClass *instance, const std::string &methodName) {
+		m_class = instance;
+		m_methodName = methodName;
+		m_name = PyString_InternFromString(methodName.c_str());
+		m_function = NULL;
+		m_type = NULL;
+		// The objects of a sub interpreter stay on its interpreter thread
+		if (!instance->m_session->m_pool)
+			resolve();
+	}
+
+	PyMethodHandle::~PyMethodHandle() {
+		PyGILLock lock;
+		release();
+		Py_XDECREF(m_name);
+	}
+
+	/** \brief Test whether the method can be called
+Resolves the method again if the instance attribute has been rebound since last call.
+*/
+	bool PyMethodHandle::isValid() {
+		if (m_class->m_session->m_pool)
+			return false;
+		PyGILLock lock;
+		if (upToDate())
+			return true;
+		return resolve();
+	}
+
+	/** \brief Call the method
+Like PyClass::callMethod() only without creating a bound method.
+
+  @param args Arguments being passed (NULL meens no arguments)
+
+*/
+	PyValue *PyMethodHandle::call(PyValue *args) {
+		if (m_class->m_session->m_pool) {
+			// Instances of a PyInterpreterPool are called on the interpreter thread
+			return m_class->callMethod(m_methodName,args);
+		}
+		PyGILLock lock;
+		PyObject *pArgs, *pValue;
+		if (!isValid())
+			return m_class->callMethod(m_methodName,args);
+
+		pArgs = selfArguments(m_class->m_session->pyValueToPyObject(args,true));
+		pValue = PyObject_Call(m_function,pArgs,NULL);
+		Py_XDECREF(pArgs);
+		return m_class->methodResult(pValue,m_methodName);
+	}
+
+	/* The attribute found in the class of the instance - borrowed reference */
+	PyObject *PyMethodHandle::classAttribute(PyObject **type) const {
+		PyObject *instance = m_class->m_instance;
+		if (PyInstance_Check(instance)) {
+			*type = (PyObject *) ((PyInstanceObject *) instance)->in_class;
+			return classLookup(*type,m_name);
+		}
+		*type = (PyObject *) Py_TYPE(instance);
+		return _PyType_Lookup(Py_TYPE(instance),m_name);
+	}
+
+	/* Test whether the instance itself has an attribute shadowing the class attribute */
+	bool PyMethodHandle::shadowed() const {
+		PyObject *instance = m_class->m_instance;
+		PyObject *dict = NULL;
+		if (PyInstance_Check(instance)) {
+			dict = ((PyInstanceObject *) instance)->in_dict;
+		}
+		else {
+			PyObject **dictptr = _PyObject_GetDictPtr(instance);
+			if (dictptr)
+				dict = *dictptr;
+		}
+		return dict && PyDict_GetItem(dict,m_name);
+	}
+
+	bool PyMethodHandle::upToDate() const {
+		if (!m_function || shadowed())
+			return false;
+		PyObject *type;
+		PyObject *function = classAttribute(&type);
+		return type == m_type && function == m_function;
+	}
+
+	bool PyMethodHandle::resolve() {
+		release();
+		if (!m_name || shadowed())
+			return false;
+		PyObject *type;
+		PyObject *function = classAttribute(&type);
+		// Only plain python functions are cached, everything else goes through callMethod()
+		if (function && PyFunction_Check(function)) {
+			Py_INCREF(function);
+			Py_INCREF(type);
+			m_function = function;
+			m_type = type;
+		}
+		return m_function != NULL;
+	}
+
+	void PyMethodHandle::release() {
+		Py_XDECREF(m_function);
+		Py_XDECREF(m_type);
+		m_function = NULL;
+		m_type = NULL;
+	}
+
+	/* Prepend the instance to the argument tuple, pArgs is DECREF'ed */
+	PyObject *PyMethodHandle::selfArguments(PyObject *pArgs) const {
+		Py_ssize_t size = PyTuple_Size(pArgs);
+		PyObject *pSelfArgs = PyTuple_New(size+1);
+		Py_INCREF(m_class->m_instance);
+		PyTuple_SET_ITEM(pSelfArgs,0,m_class->m_instance);
+		for (Py_ssize_t i=0;i<size;i++) {
+			PyObject *item = PyTuple_GET_ITEM(pArgs,i);
+			Py_INCREF(item);
+			PyTuple_SET_ITEM(pSelfArgs,i+1,item);
+		}
+		Py_DECREF(pArgs);
+		return pSelfArgs;
+	}
+}
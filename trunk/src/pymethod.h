@@ -0,0 +1,51 @@
+#ifndef PYMETHOD_H
+#define PYMETHOD_H
+
+#include "pyembdef.h"
+#include "pyvalue.h"
+
+#pragma warning( disable: 4251 )
+
+struct _object;
+typedef _object PyObject;
+
+namespace PyEmb {
+	class PyClass;
+
+	/** \class PyMethodHandle
+ A PyMethodHandle is a method of a class instance resolved once through PyClass::resolveMethod().
+ The handle caches the function found in the class and calls it with the instance as first argument,
+ so no bound method object is created per call.
+ <br><br>
+ Before every call the handle checks that the instance attribute hasn't been rebound - in the
+ instance, its class or a base class. If it has, the method is resolved again.
+ Handles of PyInterpreterPool instances are not resolved, isValid() returns false and call() goes
+ through PyClass::callMethod() on the interpreter thread of the instance.
+ Handles are owned by the PyClass which created them and may not be deleted by the calling instance.
+*/
+	class PYEMB_DECLSPEC PyMethodHandle {
+
+	public:
+		PyMethodHandle(PyClass *instance, const std::string &methodName);
+		~PyMethodHandle();
+		PyValue *call(PyValue *args=NULL);  // Garbage collection
+		bool isValid();
+		const std::string &methodName() const {return m_methodName;}
+
+	private:
+		bool shadowed() const;
+		bool upToDate() const;
+		bool resolve();
+		void release();
+		PyObject *classAttribute(PyObject **type) const;
+		PyObject *selfArguments(PyObject *pArgs) const;
+
+		PyClass *m_class;
+		std::string m_methodName;
+		PyObject *m_name;
+		PyObject *m_function;
+		PyObject *m_type;
+	};
+}
+
+#endif
@@ -0,0 +1,473 @@
+#include <Python.h>
+#include <pythread.h>
+#include "pyprocesspool.h"
+#include "pyvaluecodec.h"
+#include "pyshmring.h"
+#include "pyfuture.h"
+#include "pygil.h"
+
+#include <deque>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace PyEmb {
+	/* Requests sent to a worker process, each starting with one of these */
+	enum {
+		ProcessCall = 'C',
+		ProcessImport = 'I',
+		ProcessPath = 'P',
+		ProcessQuit = 'Q'
+	};
+
+	/* Responses start with one of these */
+	enum {
+		ProcessResult = 'R',
+		ProcessException = 'E'
+	};
+
+	/* A worker process and the thread of the pool reading its responses.
+	   Responses arrive in the order of the requests, so the futures waiting for them are queued */
+	struct PyProcessWorker {
+		PyProcessPool *pool;
+		int pid;
+		int host;							// pid of the process which forked the worker
+		PyShmRing *requests;
+		PyShmRing *responses;
+		std::deque<PyFuture*> pending;
+		PyThread_type_lock sendLock;		// one request written at a time
+		PyThread_type_lock pendingLock;		// pending, alive and stopping
+		PyThread_type_lock readerDone;
+		bool alive;
+		bool stopping;
+	};
+
+	/* Take the next turn of a counter shared by the calling threads */
+	static unsigned long nextTurn(volatile long &counter) {
+#ifdef WIN32
+		return (unsigned long) InterlockedIncrement(&counter) - 1;
+#else
+		return (unsigned long) __sync_fetch_and_add(&counter,1);
+#endif
+	}
+
+	/** \brief Constructor
+
+  @param processes Number of worker processes (at least one)
+  @param autoAlert Automatically display python exceptions
+  @param bufferSize Size in bytes of the buffers for arguments and for results of each worker
+
+*/
+	PyProcessPool::PyProcessPool(int processes, bool autoAlert, unsigned int bufferSize) {
+		m_nextWorker = 0;
+		m_main = new PySession(autoAlert);
+		if (processes < 1)
+			processes = 1;
+#ifdef WIN32
+		lastError()->setDoingWhat("Creating process pool");
+		lastError()->setException("ProcessError");
+		lastError()->setExceptionValue("Process pools are not supported on this platform");
+#else
+		{
+			// Forking while holding the GIL leaves the child a consistent interpreter
+			PyGILLock lock;
+			std::cout.flush();
+			fflush(NULL);
+			for (int i=0;i<processes;i++) {
+				PyProcessWorker *worker = new PyProcessWorker;
+				worker->pool = this;
+				worker->host = getpid();
+				worker->requests = PyShmRing::create(bufferSize);
+				worker->responses = PyShmRing::create(bufferSize);
+				worker->pid = worker->requests && worker->responses ? fork() : -1;
+				if (worker->pid == 0) {
+					PyOS_AfterFork();
+					serve(worker);
+				}
+				if (worker->pid < 0) {
+					if (worker->requests)
+						PyShmRing::destroy(worker->requests);
+					if (worker->responses)
+						PyShmRing::destroy(worker->responses);
+					delete worker;
+					lastError()->setDoingWhat("Creating process pool");
+					lastError()->setException("ProcessError");
+					lastError()->setExceptionValue("Can't start a worker process");
+					break;
+				}
+				m_workers.push_back(worker);
+			}
+		}
+		// Reader threads are started when all workers are forked, the workers inherit none of them
+		PyProcessWorkerArray::iterator it_worker = m_workers.begin();
+		for (; it_worker != m_workers.end(); ++it_worker) {
+			PyProcessWorker *worker = *it_worker;
+			worker->sendLock = PyThread_allocate_lock();
+			worker->pendingLock = PyThread_allocate_lock();
+			worker->readerDone = PyThread_allocate_lock();
+			PyThread_acquire_lock(worker->readerDone,WAIT_LOCK);
+			worker->alive = true;
+			worker->stopping = false;
+			PyThread_start_new_thread(readerMain,worker);
+		}
+#endif
+	}
+
+	/** \brief Destructor. Waits for the calls in progress and ends the worker processes */
+	PyProcessPool::~PyProcessPool() {
+		std::string quit(1,(char) ProcessQuit);
+		PyProcessWorkerArray::iterator it_worker = m_workers.begin();
+		for (; it_worker != m_workers.end(); ++it_worker) {
+			PyProcessWorker *worker = *it_worker;
+			PyThread_acquire_lock(worker->sendLock,WAIT_LOCK);
+			worker->requests->write(quit);
+			PyThread_release_lock(worker->sendLock);
+			PyThread_acquire_lock(worker->pendingLock,WAIT_LOCK);
+			worker->stopping = true;
+			PyThread_release_lock(worker->pendingLock);
+		}
+		for (it_worker = m_workers.begin(); it_worker != m_workers.end(); ++it_worker) {
+			PyProcessWorker *worker = *it_worker;
+			PyThread_acquire_lock(worker->readerDone,WAIT_LOCK);
+			PyThread_free_lock(worker->readerDone);
+			PyThread_free_lock(worker->pendingLock);
+			PyThread_free_lock(worker->sendLock);
+			PyShmRing::destroy(worker->requests);
+			PyShmRing::destroy(worker->responses);
+			delete worker;
+		}
+		delete m_main;
+	}
+
+	/** \brief Number of worker processes still running */
+	int PyProcessPool::size() {
+		int alive = 0;
+		PyProcessWorkerArray::iterator it_worker = m_workers.begin();
+		for (; it_worker != m_workers.end(); ++it_worker) {
+			PyThread_acquire_lock((*it_worker)->pendingLock,WAIT_LOCK);
+			if ((*it_worker)->alive)
+				alive++;
+			PyThread_release_lock((*it_worker)->pendingLock);
+		}
+		return alive;
+	}
+
+	/** \brief Add an absolute path to sys.path of every worker process.
+See PySession::addToPyPath()
+*/
+	void PyProcessPool::addToPyPath(const std::string &path) {
+		broadcast(ProcessPath,path);
+	}
+
+	/** \brief Import a python module in every worker process.
+See PySession::importModule()
+
+Returns false if the import failed in any of the workers.
+*/
+	bool PyProcessPool::importModule(const std::string &moduleName) {
+		return broadcast(ProcessImport,moduleName);
+	}
+
+	/** \brief Call a python function in one of the worker processes and wait for the result.
+See PySession::callFunction()
+*/
+	PyValue *PyProcessPool::callFunction(const std::string &moduleName, const std::string &functionName, PyValue *args) {
+		PyFuture *future = callFunctionAsync(moduleName,functionName,args);
+		if (!future->ok()) {
+			*lastError() = future->error();
+			return NULL;
+		}
+		return &future->m_value;
+	}
+
+	/** \brief Send a python function call to the worker process with the fewest calls waiting.
+See PySession::callFunctionAsync(). The callback is called on a thread of the pool.
+*/
+	PyFuture *PyProcessPool::callFunctionAsync(const std::string &moduleName, const std::string &functionName, PyValue *args,
+		PyFutureCallback callback, void *userData) {
+		std::string request(1,(char) ProcessCall);
+		PyValueCodec::encodeString(moduleName,request);
+		PyValueCodec::encodeString(functionName,request);
+		request += (char) (args != NULL);
+		if (args)
+			PyValueCodec::encode(*args,request);
+		return send(leastLoaded(),request,callback,userData);
+	}
+
+	/** \brief Delete the results of the calling thread.
+See PySession::emptyResultBuffer()
+*/
+	void PyProcessPool::emptyResultBuffer() {
+		m_main->emptyResultBuffer();
+	}
+
+	/** \brief Retrieve a pointer to the last python exception (error) which has occured
+in a call made by the calling thread.
+*/
+	PyError *PyProcessPool::lastError() {
+		return m_main->lastError();
+	}
+
+	/* Send the same request to every worker and wait for all of them */
+	bool PyProcessPool::broadcast(char kind, const std::string &argument) {
+		std::string request(1,kind);
+		PyValueCodec::encodeString(argument,request);
+		PyFutureArray futures;
+		PyProcessWorkerArray::iterator it_worker = m_workers.begin();
+		for (; it_worker != m_workers.end(); ++it_worker) {
+			futures.push_back(send(*it_worker,request,NULL,NULL));
+		}
+		bool ok = true;
+		PyFutureArray::iterator it_fut = futures.begin();
+		for (; it_fut != futures.end(); ++it_fut) {
+			if (!(*it_fut)->ok()) {
+				*lastError() = (*it_fut)->error();
+				ok = false;
+			}
+		}
+		return ok;
+	}
+
+	/* Queue a future for the worker's response and write the request */
+	PyFuture *PyProcessPool::send(PyProcessWorker *worker, const std::string &request, PyFutureCallback callback, void *userData) {
+		PyFuture *future = new PyFuture(callback,userData);
+		m_main->storeFuture(future);
+		if (!worker) {
+			fail(future,"Sending request","No worker process is running");
+			return future;
+		}
+		if (!worker->requests->fits(request)) {
+			fail(future,"Sending request","The arguments exceed the buffer size of the pool");
+			return future;
+		}
+		PyThread_acquire_lock(worker->sendLock,WAIT_LOCK);
+		PyThread_acquire_lock(worker->pendingLock,WAIT_LOCK);
+		bool alive = worker->alive;
+		if (alive)
+			worker->pending.push_back(future);
+		PyThread_release_lock(worker->pendingLock);
+		// If the write fails the worker has exited and its reader fails the future
+		if (alive)
+			worker->requests->write(request);
+		PyThread_release_lock(worker->sendLock);
+		if (!alive)
+			fail(future,"Sending request","The worker process has exited");
+		return future;
+	}
+
+	/* The running worker with the fewest calls waiting. The search starts at the next
+	   worker in turn, so idle workers share the calls */
+	PyProcessWorker *PyProcessPool::leastLoaded() {
+		int count = m_workers.size();
+		if (!count)
+			return NULL;
+		int start = nextTurn(m_nextWorker) % count;
+		PyProcessWorker *best = NULL;
+		int depth = 0;
+		for (int i=0;i<count;i++) {
+			PyProcessWorker *worker = m_workers[(start+i) % count];
+			PyThread_acquire_lock(worker->pendingLock,WAIT_LOCK);
+			int workerDepth = worker->pending.size();
+			bool alive = worker->alive;
+			PyThread_release_lock(worker->pendingLock);
+			if (alive && (!best || workerDepth < depth)) {
+				best = worker;
+				depth = workerDepth;
+				if (!depth)
+					break;
+			}
+		}
+		return best;
+	}
+
+	/* Complete a future with an error raised by the pool itself */
+	void PyProcessPool::fail(PyFuture *future, const std::string &doingWhat, const std::string &message) {
+		future->m_ok = false;
+		future->m_error.setDoingWhat(doingWhat);
+		future->m_error.setException("ProcessError");
+		future->m_error.setExceptionValue(message);
+		future->complete();
+	}
+
+	/* Complete a future with a worker's response */
+	void PyProcessPool::complete(PyFuture *future, const std::string &response) {
+		const char *pos = response.data();
+		const char *end = pos+response.size();
+		char status = pos < end ? *pos++ : 0;
+		if (status == ProcessResult) {
+			future->m_ok = PyValueCodec::decode(pos,end,future->m_value);
+		}
+		else {
+			std::string doingWhat, exception, exceptionValue, traceback;
+			PyValueCodec::decodeString(pos,end,doingWhat);
+			PyValueCodec::decodeString(pos,end,exception);
+			PyValueCodec::decodeString(pos,end,exceptionValue);
+			PyValueCodec::decodeString(pos,end,traceback);
+			future->m_ok = false;
+			future->m_error.setDoingWhat(doingWhat);
+			future->m_error.setException(exception);
+			future->m_error.setExceptionValue(exceptionValue);
+			future->m_error.setTraceback(traceback);
+			if (m_main->autoAlertEnabled()) {
+				*lastError() = future->m_error;
+				m_main->raiseErrorMessage();
+			}
+		}
+		future->complete();
+	}
+
+#ifndef WIN32
+	/* Reads a worker's responses until the pool is destroyed or the worker exits */
+	void PyProcessPool::readerMain(void *data) {
+		PyProcessWorker *worker = (PyProcessWorker *) data;
+		PyProcessPool *pool = worker->pool;
+		std::string response;
+		bool exited = false;
+		int status = 0;
+		for (;;) {
+			if (worker->responses->read(response,exited ? 0 : 100)) {
+				PyThread_acquire_lock(worker->pendingLock,WAIT_LOCK);
+				PyFuture *future = worker->pending.front();
+				worker->pending.pop_front();
+				PyThread_release_lock(worker->pendingLock);
+				pool->complete(future,response);
+				continue;
+			}
+			if (exited)
+				break;
+			PyThread_acquire_lock(worker->pendingLock,WAIT_LOCK);
+			bool done = worker->stopping && worker->pending.empty();
+			PyThread_release_lock(worker->pendingLock);
+			if (done)
+				break;
+			// Responses written before the worker exited are still read
+			exited = waitpid(worker->pid,&status,WNOHANG) == worker->pid;
+		}
+
+		if (exited) {
+			PyThread_acquire_lock(worker->pendingLock,WAIT_LOCK);
+			worker->alive = false;
+			std::deque<PyFuture*> lost;
+			lost.swap(worker->pending);
+			PyThread_release_lock(worker->pendingLock);
+			worker->requests->close();
+
+			std::ostringstream message;
+			message << "Worker process " << worker->pid;
+			if (WIFSIGNALED(status))
+				message << " was killed by signal " << WTERMSIG(status);
+			else
+				message << " exited with status " << WEXITSTATUS(status);
+			std::deque<PyFuture*>::iterator it_fut = lost.begin();
+			for (; it_fut != lost.end(); ++it_fut) {
+				pool->fail(*it_fut,"Waiting for a worker process",message.str());
+			}
+		}
+		else {
+			waitpid(worker->pid,&status,0);
+		}
+		PyThread_release_lock(worker->readerDone);
+	}
+
+	/* Module of a worker process, imported on first use. Returns a borrowed reference */
+	static PyObject *workerModule(PyModuleMap &modules, const std::string &moduleName) {
+		PyModuleMap::iterator it_mod = modules.find(moduleName);
+		if (it_mod != modules.end())
+			return it_mod->second;
+		PyObject *pModule = PyImport_ImportModule(moduleName.c_str());
+		if (pModule)
+			modules[moduleName] = pModule;
+		return pModule;
+	}
+
+	/* Main loop of a worker process, which holds the GIL throughout. Never returns */
+	void PyProcessPool::serve(PyProcessWorker *worker) {
+		PyModuleMap modules;
+		std::string request, response;
+		for (;;) {
+			if (!worker->requests->read(request,1000)) {
+				// A worker whose host has died exits instead of waiting for requests forever
+				if (getppid() != worker->host)
+					break;
+				continue;
+			}
+			const char *pos = request.data();
+			const char *end = pos+request.size();
+			char kind = *pos++;
+			if (kind == ProcessQuit)
+				break;
+
+			std::string moduleName, functionName;
+			std::ostringstream doingwhat;
+			PyObject *pResult = NULL;
+			PyValueCodec::decodeString(pos,end,moduleName);
+			switch (kind) {
+			case ProcessPath:
+				m_main->addToPyPath(moduleName);
+				Py_INCREF(Py_None);
+				pResult = Py_None;
+				break;
+			case ProcessImport:
+				doingwhat << "Importing " << moduleName << std::endl;
+				pResult = workerModule(modules,moduleName);
+				Py_XINCREF(pResult);
+				break;
+			case ProcessCall: {
+				PyValueCodec::decodeString(pos,end,functionName);
+				doingwhat << "Calling " << moduleName << "." << functionName << std::endl;
+				bool hasArgs = pos < end && *pos++;
+				PyObject *pArgs = hasArgs ? PyValueCodec::decode(pos,end) : PyTuple_New(0);
+				if (pArgs && !PyTuple_Check(pArgs))
+					pArgs = Py_BuildValue("(N)",pArgs);
+				PyObject *pModule = workerModule(modules,moduleName);
+				PyObject *pFunc = pModule ? PyObject_GetAttrString(pModule,functionName.c_str()) : NULL;
+				if (pFunc && pArgs)
+					pResult = PyObject_CallObject(pFunc,pArgs);
+				Py_XDECREF(pFunc);
+				Py_XDECREF(pArgs);
+				break;
+			}
+			}
+
+			response.assign(1,(char) ProcessResult);
+			if (pResult && PyValueCodec::encode(pResult,response) && worker->responses->fits(response)) {
+				Py_DECREF(pResult);
+				worker->responses->write(response);
+				continue;
+			}
+			PyError error;
+			if (PyErr_Occurred()) {
+				m_main->storeError(&error);
+			}
+			else {
+				error.setException("ProcessError");
+				error.setExceptionValue(pResult ? "The result exceeds the buffer size of the pool" : "Malformed request");
+			}
+			Py_XDECREF(pResult);
+			response.assign(1,(char) ProcessException);
+			PyValueCodec::encodeString(doingwhat.str(),response);
+			PyValueCodec::encodeString(error.exception(),response);
+			PyValueCodec::encodeString(error.exceptionValue(),response);
+			PyValueCodec::encodeString(error.traceback(),response);
+			worker->responses->write(response);
+		}
+		std::cout.flush();
+		fflush(NULL);
+		_exit(0);
+	}
+#else
+	void PyProcessPool::readerMain(void *) {
+	}
+
+	void PyProcessPool::serve(PyProcessWorker *) {
+	}
+#endif
+}
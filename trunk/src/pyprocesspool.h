@@ -0,0 +1,70 @@
+#ifndef PYPROCESSPOOL_H
+#define PYPROCESSPOOL_H
+
+#include "pyembdef.h"
+#include "pysession.h"
+
+#include <vector>
+#include <string>
+
+#pragma warning( disable: 4251 )
+
+namespace PyEmb {
+	struct PyProcessWorker;
+
+	typedef std::vector<PyProcessWorker*> PyProcessWorkerArray;
+
+	/** \class PyProcessPool
+ A PyProcessPool runs python function calls in a number of worker processes, each with its own
+ python interpreter and global interpreter lock, so CPU bound python code runs in parallel. A worker
+ which crashes takes only its own calls down.
+ <br><br>
+ TRANSPORT <br>
+ Arguments and results are encoded into a ring buffer in memory shared with the worker and decoded
+ into python objects on the other side, without pickling. Arguments and results must fit the buffer
+ as a whole, the size of which is given to the constructor.
+ <br><br>
+ The workers are forked from the calling process when the pool is created and inherit the modules
+ imported up to then. Modules imported and paths added through the pool afterwards reach all
+ workers. Class instances can't be shared between processes, use PyInterpreterPool for those.
+ Calls of a worker which has exited fail with a ProcessError, the other workers take over.
+ <br><br>
+ Process pools need fork() and are not available on windows, where the constructor reports an error
+ and all calls fail.
+ <br><br>
+ GARBAGE COLLECTION <br>
+ Returned pointers are owned by the pool like they are by PySession and freed by emptyResultBuffer()
+ and on destruction.
+*/
+	class PYEMB_DECLSPEC PyProcessPool {
+
+	public:
+		PyProcessPool(int processes, bool autoAlert=true, unsigned int bufferSize=4*1024*1024);
+		~PyProcessPool();
+		int size();
+		void addToPyPath(const std::string &path);
+		bool importModule(const std::string &moduleName);
+		PyValue *callFunction(const std::string &moduleName, const std::string &functionName, PyValue *args=NULL); // Garbage collection
+		PyFuture *callFunctionAsync(const std::string &moduleName, const std::string &functionName, PyValue *args=NULL,
+			PyFutureCallback callback=NULL, void *userData=NULL); // Garbage collection
+		void emptyResultBuffer();
+		PyError *lastError();
+
+	private:
+		PyProcessPool(const PyProcessPool &);
+		PyProcessPool &operator=(const PyProcessPool &);
+		bool broadcast(char kind, const std::string &argument);
+		PyFuture *send(PyProcessWorker *worker, const std::string &request, PyFutureCallback callback, void *userData);
+		PyProcessWorker *leastLoaded();
+		void fail(PyFuture *future, const std::string &doingWhat, const std::string &message);
+		void complete(PyFuture *future, const std::string &response);
+		void serve(PyProcessWorker *worker);
+		static void readerMain(void *worker);
+
+		PySession *m_main;
+		PyProcessWorkerArray m_workers;
+		volatile long m_nextWorker;
+	};
+}
+
+#endif
@@ -0,0 +1,59 @@
+#include <Python.h>
+#include "pyref.h"
+#include "pygil.h"
+
+#include <algorithm>
+
+namespace PyEmb {
+	PyRef::PyRef() {
+		m_object = NULL;
+	}
+
+	/** \brief Hold a new reference to object, which may be NULL. The GIL must be held */
+	PyRef::PyRef(PyObject *object) {
+		Py_XINCREF(object);
+		m_object = object;
+	}
+
+	PyRef::PyRef(const PyRef &other) {
+		m_object = NULL;
+		if (other.m_object) {
+			PyGILLock lock;
+			Py_INCREF(other.m_object);
+			m_object = other.m_object;
+		}
+	}
+
+	PyRef::~PyRef() {
+		if (m_object) {
+			PyGILLock lock;
+			Py_DECREF(m_object);
+		}
+	}
+
+	PyRef &PyRef::operator=(const PyRef &other) {
+		PyRef copy(other);
+		swap(copy);
+		return *this;
+	}
+
+	void PyRef::swap(PyRef &other) {
+		std::swap(m_object,other.m_object);
+	}
+
+	/** \brief Convert the object, see PyValue for lazy conversion. A null PyRef converts to None */
+	PyValue PyRef::value(bool lazy) const {
+		if (!m_object) {
+			return PyValue();
+		}
+		PyGILLock lock;
+		return PyValue(m_object,lazy);
+	}
+
+	/* Take over a new reference, fx. the result of a call */
+	PyRef PyRef::steal(PyObject *object) {
+		PyRef ref;
+		ref.m_object = object;
+		return ref;
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef PYREF_H
+#define PYREF_H
+
+#include "pyembdef.h"
+#include "pyvalue.h"
+#include <vector>
+
+#pragma warning( disable: 4251 )
+
+struct _object;
+typedef _object PyObject;
+
+namespace PyEmb {
+	/** \class PyRef
+ A PyRef holds a reference to a python object without converting it, fx. the result of
+ PySession::callFunctionRef() when it is only passed on to other calls. Copies share the object.
+ Use value() to convert it when it has to be read in C++.
+ <br><br>
+ Copying and releasing a PyRef acquires the GIL. It must be released before the PySession is destroyed.
+*/
+	class PYEMB_DECLSPEC PyRef {
+		friend class PySession;
+		friend class PyIterator;
+
+	public:
+		PyRef();
+		PyRef(PyObject *object);
+		PyRef(const PyRef &other);
+		~PyRef();
+		PyRef &operator=(const PyRef &other);
+		void swap(PyRef &other);
+		bool isNull() const {return m_object == NULL;}
+		PyObject *object() const {return m_object;}
+		PyValue value(bool lazy=false) const;
+
+	private:
+		static PyRef steal(PyObject *object);
+
+		PyObject *m_object;
+	};
+
+	typedef std::vector<PyRef> PyRefList;
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include <Python.h>
+#include "pyresultscope.h"
+#include "pyfuture.h"
+#include "pygil.h"
+
+#include <new>
+
+namespace PyEmb {
+	/* Values in the first block, later blocks double up to the largest size */
+	static const int firstBlockSize = 16;
+	static const int largestBlockSize = 4096;
+
+	/** \brief Constructor. The scope becomes the innermost of the calling thread
+
+  @param session Session whose results the scope owns
+
+*/
+	PyResultScope::PyResultScope(PySession *session) {
+		m_session = session;
+		m_used = 0;
+		m_size = 0;
+		PyThreadData *data = m_session->threadData();
+		m_outer = data->scope;
+		data->scope = this;
+	}
+
+	/** \brief Destructor. Frees the results and makes the enclosing scope the innermost again */
+	PyResultScope::~PyResultScope() {
+		m_session->threadData()->scope = m_outer;
+		release(false);
+	}
+
+	/** \brief Free the results owned by the scope so far. The scope stays in effect */
+	void PyResultScope::clear() {
+		release(true);
+	}
+
+	PyValue *PyResultScope::newValue(PyObject *pValue, bool lazy) {
+		if (m_blocks.empty() || m_used == m_blocks.back().capacity) {
+			PyResultBlock block;
+			block.capacity = m_blocks.empty() ? firstBlockSize : m_blocks.back().capacity*2;
+			if (block.capacity > largestBlockSize)
+				block.capacity = largestBlockSize;
+			block.values = static_cast<PyValue *>(operator new(block.capacity*sizeof(PyValue)));
+			m_blocks.push_back(block);
+			m_used = 0;
+		}
+		PyValue *value = new (&m_blocks.back().values[m_used]) PyValue(pValue,lazy);
+		m_used++;
+		m_size++;
+		return value;
+	}
+
+	void PyResultScope::storeFuture(PyFuture *future) {
+		m_futures.push_back(future);
+	}
+
+	/* Destroy the values and futures. Only the last block is partly used */
+	void PyResultScope::release(bool keepFirst) {
+		// Pending futures wait for the interpreter thread, so they are deleted without the GIL
+		PyFutureArray::iterator it_fut = m_futures.begin();
+		for (; it_fut != m_futures.end(); ++it_fut) {
+			delete *it_fut;
+		}
+		m_futures.erase(m_futures.begin(),m_futures.end());
+
+		PyGILLock lock;
+		for (size_t i=0;i<m_blocks.size();i++) {
+			int used = i+1 == m_blocks.size() ? m_used : m_blocks[i].capacity;
+			for (int j=0;j<used;j++) {
+				m_blocks[i].values[j].~PyValue();
+			}
+			if (i > 0 || !keepFirst)
+				operator delete(m_blocks[i].values);
+		}
+		m_blocks.resize(keepFirst && !m_blocks.empty() ? 1 : 0);
+		m_used = 0;
+		m_size = 0;
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef PYRESULTSCOPE_H
+#define PYRESULTSCOPE_H
+
+#include "pyembdef.h"
+#include "pysession.h"
+
+#include <vector>
+
+#pragma warning( disable: 4251 )
+
+struct _object;
+typedef _object PyObject;
+
+namespace PyEmb {
+	/* A block of result storage */
+	struct PyResultBlock {
+		PyValue *values;
+		int capacity;
+	};
+
+	typedef std::vector<PyResultBlock> PyResultBlockArray;
+
+	/** \class PyResultScope
+ A PyResultScope owns the results the calling thread receives from a PySession while the scope
+ exists - values returned by PySession::callFunction(), PySession::buildPyValue(), PyClass::callMethod()
+ and the handles, and futures returned by the asynchronous calls. They are freed together when the
+ scope is destroyed, instead of collecting in the result buffer until emptyResultBuffer() is called.
+ <br><br>
+ Values are allocated from blocks owned by the scope, so a scope costs a few allocations no matter
+ how many results it holds. Scopes nest, results go to the innermost scope of the calling thread.
+ A scope must be destroyed by the thread which created it and before the session.
+ <br><br>
+ Fx.
+ <br>
+ while (serving) {<br>
+ &nbsp;&nbsp;PyResultScope scope(session);<br>
+ &nbsp;&nbsp;PyValue *result = session->callFunction("handler","handle",request);<br>
+ &nbsp;&nbsp;...<br>
+ }  // result is freed here
+*/
+	class PYEMB_DECLSPEC PyResultScope {
+		friend class PySession;
+
+	public:
+		PyResultScope(PySession *session);
+		~PyResultScope();
+		int size() const {return m_size;}
+		void clear();
+
+	private:
+		PyResultScope(const PyResultScope &);
+		PyResultScope &operator=(const PyResultScope &);
+		PyValue *newValue(PyObject *pValue, bool lazy);
+		void storeFuture(PyFuture *future);
+		void release(bool keepFirst);
+
+		PySession *m_session;
+		PyResultScope *m_outer;
+		PyResultBlockArray m_blocks;
+		int m_used;
+		int m_size;
+		PyFutureArray m_futures;
+	};
+}
+
+#endif
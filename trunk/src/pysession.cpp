@@ -1,623 +1,1262 @@
-#include "pysession.h"
-#include "pyclass.h"
-#include "pyerror.h"
-
-#include <Python.h>
-#include <string>
-#include <iostream>
-#include <sstream>
-
-
-namespace PyEmb {
-	/** \brief Constructor
-
-  @param autoAlert Automatically display python exceptions
-
-PySession constructor. 
-*/
-	PySession::PySession(bool autoAlert) {
-		m_sysModsLoaded = false;
-		m_autoAlert = autoAlert;
-		Py_Initialize();
-	}
-
-	/** \brief Destructor */
-	PySession::~PySession() {
-		PyClassArray::iterator it_inst = m_instances.begin();
-		for (; it_inst != m_instances.end(); ++it_inst) {
-			delete *it_inst;
-		}
-
-		emptyResultBuffer();
-
-		PyObjectArray::iterator it_mod = m_modules.begin();
-		for (; it_mod != m_modules.end(); ++it_mod) {
-			Py_DECREF(*it_mod);
-		}
-
-		// Finalize python session
-		Py_Finalize();
-	}
-
-	/** \brief Manually delete CallFunction() resultbuffer.
-EmptyResultBuffer deletes all PyValue's administrated by PySession. Calling this actively
-requieres caution, since it deletes the PyValues you may be using currently.
-*/
-	void PySession::emptyResultBuffer() {
-		PyValueArray::iterator it_val = m_values.begin();
-		for (; it_val!=m_values.end(); ++it_val) {
-			delete *it_val;
-		}
-		m_values.erase(m_values.begin(),m_values.end());
-	}
-
-	/** \brief Import a python module. The python interpreter searches for the module
-in the python sys.path.
-
-  @param ModuleName Module to import - MyModule imports MyModule.py
-
-The default sys.path is as follows:
-<br>
-  PY_HOME = path to TRPyEmbxx.dll <br>
-  PY_HOME <br>
-  PY_HOME/PyModules<br>
-  PY_HOME/PyModules/site-packages <br>
-  PY_HOME/PyScripts<br>
-  PY_HOME/PyScripts/<running processname> (fx. PY_HOME/PyScripts/TRExport)<br>
-<br>
-Important modules:<br>
-  sys  <br>
-  os  <br>
-  os.path  <br>
-  odbc  <br>
-  cx_Oracle  <br>
-  <br>
-  <a href="http://www.python.org/doc/current/modindex.html">Python module index</a>  <br>
-  <a href="http://www.python.org/topics/database/">Python database api</a>  <br>
-  <br>
-*/
-	bool PySession::importModule(const std::string &moduleName) {
-		PyObject *pModule = loadModule(moduleName);
-		if (pModule) {
-			m_modules.push_back(pModule);
-			return true;
-		}
-		return false;
-	}
-
-	/** \brief Enable/disable autoalert for the session being. This meens that python exceptions which
-occure while importing modules, calling functions, creating class instances etc. will be
-displayed immediately.
-
-  @param autoalert True/false enable/disable repectively
-
-*/
-	void PySession::setAutoAlertEnabled(bool autoalert) {
-		m_autoAlert = autoalert;
-	}
-
-	/** \brief Test autoalert enabled/disabled */
-	bool PySession::autoAlertEnabled() {
-		return m_autoAlert;
-	}
-
-	/** \brief Create a new instance of a class. The class must be declared
-in one of the imported modules.
-See PyClass for information on calling class methods.
-
-  @param ModuleName Python module declaring the class
-  @param ClassName Class to instantiate 
-  @param Args Constructor arguments (null meens no arguments is passed)
-
-*/
-	PyClass* PySession::newInstance(const std::string &moduleName, const std::string &className,PyValue *args) {
-		PyObject *pArgs = pyValueToPyObject(args,true);
-		PyObject *pInstance = createInstance(moduleName,className,pArgs);
-		Py_XDECREF(pArgs);
-		if (pInstance) {
-			PyClass *pyClassInstance = new PyClass(pInstance,this);
-			m_instances.push_back(pyClassInstance);
-			return pyClassInstance;
-		}
-		return NULL;
-	}
-
-
-	/** \brief Add an absolute path to python sys.path.
-Only one path at the time
-
-  @param path The absolute path to be added
-
-You can display the current path by calling ShowPath()
-
-*/
-	void PySession::addToPyPath(const std::string &path) {
-		PyObject *syspath = PySys_GetObject((char *) "path");
-		PyObject *pathstr = PyString_FromString(path.c_str());
-		PyList_Append(syspath,pathstr);
-		Py_XDECREF(pathstr);
-	}
-
-	/** \brief Create and display a messagebox containing
-the current python sys.path.
-
-  Python sys.path determins in which order the python
-  interpreter will search for modules.
-  You can add elements to python sys.path by calling
-  AddToPyPath().
-*/
-	void PySession::showPath() {
-		PyObject *syspath = PySys_GetObject((char *) "path");
-		PyObject *seperator = PyString_FromString(";");
-		PyObject *pathstr = _PyString_Join(seperator,syspath);
-		Py_XDECREF(seperator);
-
-		std::ostringstream newpath;
-		newpath << (const char*) PyString_AsString(pathstr);
-
-		Py_XDECREF(pathstr);
-		std::cout << newpath.str();
-	}
-
-
-#define TRACEBACK_FETCH_ERROR(what) {errMsg = what; goto done;}
-
-	char *pyTraceback_AsString(PyObject *exc_tb) {
-		char *errMsg = NULL; /* holds a local error message */
-		char *result = NULL; /* a valid, allocated result. */
-		PyObject *modStringIO = NULL;
-		PyObject *modTB = NULL;
-		PyObject *obFuncStringIO = NULL;
-		PyObject *obStringIO = NULL;
-		PyObject *obFuncTB = NULL;
-		PyObject *argsTB = NULL;
-		PyObject *obResult = NULL;
-
-		/* Import the modules we need - cStringIO and traceback */
-		modStringIO = PyImport_ImportModule("cStringIO");
-		if (modStringIO==NULL)
-			TRACEBACK_FETCH_ERROR((char *) "cant import cStringIO\n");
-
-		modTB = PyImport_ImportModule("traceback");
-		if (modTB==NULL)
-			TRACEBACK_FETCH_ERROR((char *) "cant import traceback\n");
-		/* Construct a cStringIO object */
-		obFuncStringIO = PyObject_GetAttrString(modStringIO, "StringIO");
-		if (obFuncStringIO==NULL)
-			TRACEBACK_FETCH_ERROR((char *) "cant find cStringIO.StringIO\n");
-		obStringIO = PyObject_CallObject(obFuncStringIO, NULL);
-		if (obStringIO==NULL)
-			TRACEBACK_FETCH_ERROR((char *) "cStringIO.StringIO() failed\n");
-		/* Get the traceback.print_exception function, and call it. */
-		obFuncTB = PyObject_GetAttrString(modTB, "print_tb");
-		if (obFuncTB==NULL)
-			TRACEBACK_FETCH_ERROR((char *) "cant find traceback.print_tb\n");
-
-		argsTB = Py_BuildValue("OOO",
-							   exc_tb  ? exc_tb  : Py_None,
-							   Py_None,
-							   obStringIO);
-		if (argsTB==NULL)
-			TRACEBACK_FETCH_ERROR((char *) "cant make print_tb arguments\n");
-
-		obResult = PyObject_CallObject(obFuncTB, argsTB);
-		if (obResult==NULL)
-			TRACEBACK_FETCH_ERROR((char *) "traceback.print_tb() failed\n");
-		/* Now call the getvalue() method in the StringIO instance */
-		Py_DECREF(obFuncStringIO);
-		obFuncStringIO = PyObject_GetAttrString(obStringIO, "getvalue");
-		if (obFuncStringIO==NULL)
-			TRACEBACK_FETCH_ERROR((char *) "cant find getvalue function\n");
-		Py_DECREF(obResult);
-		obResult = PyObject_CallObject(obFuncStringIO, NULL);
-		if (obResult==NULL)
-			TRACEBACK_FETCH_ERROR((char *) "getvalue() failed.\n");
-
-		/* And it should be a string all ready to go - duplicate it. */
-		if (!PyString_Check(obResult))
-			TRACEBACK_FETCH_ERROR((char *) "getvalue() did not return a string\n");
-
-		{ // a temp scope so I can use temp locals.
-			char *tempResult = PyString_AsString(obResult);
-			result = (char *)PyMem_Malloc(strlen(tempResult)+1);
-			if (result==NULL)
-				TRACEBACK_FETCH_ERROR((char *) "memory error duplicating the traceback string\n");
-
-			strcpy(result, tempResult);
-		} // end of temp scope.
-		done:
-		/* All finished - first see if we encountered an error */
-		if (result==NULL && errMsg != NULL) {
-			result = (char *)PyMem_Malloc(strlen(errMsg)+1);
-			if (result != NULL)
-				/* if it does, not much we can do! */
-				strcpy(result, errMsg);
-		}
-		Py_XDECREF(modStringIO);
-		Py_XDECREF(modTB);
-		Py_XDECREF(obFuncStringIO);
-		Py_XDECREF(obStringIO);
-		Py_XDECREF(obFuncTB);
-		Py_XDECREF(argsTB);
-		Py_XDECREF(obResult);
-		return result;
-	}
-
-	void PySession::storeError(PyError *error) {
-		PyObject *err_type, *err_value, *err_traceback;
-		int have_error = PyErr_Occurred() ? 1 : 0;
-		if (have_error) {
-			PyErr_Fetch(&err_type, &err_value, &err_traceback);
-		}
-		else {
-			return;
-		}
-		error->setTraceback(pyTraceback_AsString(err_traceback));
-
-		PyObject *temp = PyObject_Str(err_type);
-		if (temp) {
-			error->setException(PyString_AsString(temp));
-			Py_DECREF(temp);
-		}
-		else {
-			error->setException("Can't convert exception to a string!");
-		}
-		if (err_value != NULL) {
-			temp = PyObject_Str(err_value);
-			if (temp) {
-				error->setExceptionValue(PyString_AsString(temp));
-				Py_DECREF(temp);
-			}
-			else {
-				error->setExceptionValue("Can't convert exception value to a string!");
-			}
-		}
-	}
-
-	/** \brief Retrieve a pointer
-to the last python exception (error) which has occured.
-*/
-	PyError *PySession::lastError() {
-		return &m_lastError;
-	}
-
-
-	PyObject* PySession::loadModule(const std::string &moduleName) {
-		PyObject *pName, *pModule;
-
-		pName = PyString_FromString(moduleName.c_str());
-		/* Error checking of pName left out */
-
-		pModule = PyImport_Import(pName);
-		if (pModule == NULL) {
-			std::ostringstream doingwhat;
-			doingwhat << "Importing " << moduleName << std::endl;
-
-			m_lastError.setDoingWhat(doingwhat.str());
-			storeError(&m_lastError);
-			if (autoAlertEnabled()) {
-				raiseErrorMessage();
-				showPath();
-			}
-			return NULL;
-		}
-		Py_XDECREF(pName);
-		return pModule;
-	}
-
-
-	/** \brief This method creates and displays a messagebox
-containing information about the latest python exception (error)
-
-This method is called automatically when autoAlert is enabled - 
-SetAutoAlertEnabled().
-*/
-	void PySession::raiseErrorMessage()
-	{
-		std::ostringstream error;
-
-		error << "Python exception occured while:" << std::endl;
-		error << lastError()->doingWhat() << std::endl;
-		error << lastError()->traceback() << lastError()->exception() << std::endl;
-		error << lastError()->exceptionValue() << std::endl;
-
-		std::cout << error.str();
-	}
-
-	PyObject* PySession::loadedModule(const std::string &moduleName) {
-		PyObject *pModule=NULL;
-		PyObjectArray::iterator it_mod = m_modules.begin();
-		for (; it_mod != m_modules.end(); ++it_mod) {
-			char *modName = PyModule_GetName(*it_mod);
-			if (!strcmp(modName,moduleName.c_str())) {
-				pModule = *it_mod;
-				break;
-			}
-		}
-		return pModule;
-	}
-
-	PyObject* PySession::createInstance(const std::string &moduleName,const std::string &className,PyObject *args) {
-		PyObject *pModule, *pDict, *pClass, *pInstance;
-		pModule = pDict = pClass = pInstance = NULL;
-
-		pModule = loadedModule(moduleName);
-		if (!pModule)
-			importModule(moduleName);
-		pModule = loadedModule(moduleName);
-
-		if (pModule) {
-			// Module found now attempt to make an instance
-			pDict = PyModule_GetDict(pModule);                        // Try to load module dictionary
-			if (!pDict)
-				return NULL;
-			else {
-				pClass = PyDict_GetItemString(pDict, (char *) className.c_str());     // Get class reference
-				if (pClass) {
-					pInstance = PyInstance_New(pClass,args,NULL);           // Create it
-				}
-			}
-			if (!pInstance)
-			{
-				std::ostringstream doingwhat;
-				doingwhat << "Creating instance of class " << className << " from module " << moduleName << std::endl;
-				m_lastError.setDoingWhat(doingwhat.str());
-				storeError(&m_lastError);
-				if (autoAlertEnabled())
-					raiseErrorMessage();
-			}
-		}
-		return pInstance;
-	}
-
-	void PySession::loadSysMods() {
-		if (m_sysModsLoaded)
-			return;
-		if (importModule("sys") &&
-			importModule("os"))
-			m_sysModsLoaded = true;
-	}
-
-
-	/** \brief Call a python function
-from an imported module using PyValue as return type and 
-argument passing. Use BuildPyValue() to create arguments.
-
-  @param Module Module containing function
-  @param Function Function to be called
-  @param Arguments Arguments being passed (NULL meens no arguments)
-
-*/
-	PyValue *PySession::callFunction(const std::string &moduleName, const std::string &functionName, PyValue *args) {
-		PyValue *result = NULL;
-		PyObject *pModule, *pDict, *pFunc;
-		PyObject *pArgs, *pValue;
-		/* Open a file handle. */
-
-		pModule = loadedModule(moduleName);
-		if (!pModule)
-			importModule(moduleName);
-		pModule = loadedModule(moduleName);
-
-		if (pModule) {
-			pDict = PyModule_GetDict(pModule);
-			pFunc = PyDict_GetItemString(pDict,(char *) functionName.c_str());
-
-			/* pFunc: Borrowed reference */
-			if (pFunc && PyCallable_Check(pFunc)) {
-				pArgs = pyValueToPyObject(args,true);
-				pValue = PyObject_CallObject(pFunc, pArgs);
-				if (pValue != NULL) {
-					result = new PyValue(pValue);
-					Py_DECREF(pValue);
-					m_values.push_back(result);
-				}
-				else {
-					std::ostringstream doingwhat;
-					doingwhat << "Calling function " << functionName << " in module " << moduleName << std::endl;
-					m_lastError.setDoingWhat(doingwhat.str());
-					storeError(&m_lastError);
-					if (autoAlertEnabled())
-						raiseErrorMessage();
-				}
-				Py_XDECREF(pArgs);
-				/* pDict and pFunc are borrowed and must not be Py_DECREF-ed */
-			}
-			else {
-				//      PyErr_Print();
-				std::cerr << "Cannot find function \"" << functionName << "\"" << std::endl;
-			}
-		}
-		return result;
-	}
-	/** \brief Call python function
-Like CallFunction() only it takes a PyObject as argument
-PyValueToPyObject() can be used to convert a PyValue to a PyObject.
-
-  @param Module Module containing function
-  @param Function Function to be called
-  @param pArgs Arguments being passed (NULL meens no arguments)
-
-*/
-	PyValue *PySession::callFunctionObj(const std::string &moduleName, const std::string &functionName, PyObject *pArgs) {
-		PyValue *result = NULL;
-		PyObject *pModule, *pDict, *pFunc;
-		PyObject *pValue;
-		/* Open a file handle. */
-
-		pModule = loadedModule(moduleName);
-		if (!pModule)
-			importModule(moduleName);
-		pModule = loadedModule(moduleName);
-
-		if (pModule) {
-			pDict = PyModule_GetDict(pModule);
-			/* pDict is a borrowed reference */
-			//pFunc = PyDict_GetItemString(pDict, Function.GetBuffer(Function.GetLength()));
-			pFunc = PyDict_GetItemString(pDict,(char*)functionName.c_str());
-			/* pFun: Borrowed reference */
-			if (pFunc && PyCallable_Check(pFunc)) {
-				pValue = PyObject_CallObject(pFunc, pArgs);
-				if (pValue != NULL) {
-					result = new PyValue(pValue);
-					Py_DECREF(pValue);
-					m_values.push_back(result);
-				}
-				else {
-					std::ostringstream doingwhat;
-					doingwhat << "Calling function " << functionName << " in module " << moduleName << std::endl;
-					m_lastError.setDoingWhat(doingwhat.str());
-					storeError(&m_lastError);
-					if (autoAlertEnabled()) {
-						raiseErrorMessage();
-					}
-				}
-				Py_XDECREF(pArgs);
-				/* pDict and pFunc are borrowed and must not be Py_DECREF-ed */
-			}
-			else {
-				std::cerr << "Cannot find function \"" << functionName << "\"" << std::endl;
-			}
-		}
-		return result;
-	}
-
-	/** \brief PyValue to PyObject conversion
-Converts a PyValue instance to a PyObject. Setting forceTuple to true
-will force the any PyValue into a tuple PyObject. This is usefull for
-calling pythonfunctions since they only accept tupleobjects
-
-  @param inValue PyValue to be converted
-  @param forceTuple Force singlevalues into a single element tuple
-
-*/
-	PyObject *PySession::pyValueToPyObject(PyValue *inValue,bool forceTuple) {
-		PyObject *pTuple,*pValue;
-		pTuple = pValue = NULL;
-		PyTuple tuple;
-		if (!inValue) {
-			if (forceTuple) {
-				pTuple = PyTuple_New(0);
-				return pTuple;
-			}
-			else {
-				return NULL;
-			}
-		}
-		if (inValue->valueType()==PyValue::PyTupleType) {
-			tuple = inValue->valueAsTuple();
-			pTuple = PyTuple_New(tuple.size());
-
-			for (int i=0;i<tuple.size();i++) {
-				PyTuple_SetItem(pTuple,i,pyValueToPyObject(tuple.value(i)));
-			}
-			return pTuple;
-		}
-		if (inValue->valueType()==PyValue::PyLongType) {
-			long longval;
-			longval = inValue->valueAsLong();
-			pValue = PyLong_FromLong(longval);
-		}
-		else if (inValue->valueType()==PyValue::PyDoubleType) {
-			double doubval;
-			doubval = inValue->valueAsDouble();
-			pValue = PyFloat_FromDouble(doubval);
-		}
-		else if (inValue->valueType()==PyValue::PyStringType)	{
-			std::string strval;
-			strval = inValue->valueAsString();
-			pValue = PyString_FromString(strval.c_str());
-		}
-		if (forceTuple)	{
-			pTuple = PyTuple_New(1);
-			PyTuple_SetItem(pTuple,0,pValue);
-			return pTuple;
-		}
-		return pValue;
-	}
-
-
-	/** \brief Build a PyValue object
-
-  @param Format  's' (string) [char *] 
-  's#' (string) [char *, int] <br>
- *'z' (string or None) [char *] <br>
- *'z#' (string or None) [char *, int] <br>
- *'i' (integer) [int] 
- *'b' (integer) [char] 
- *'h' (integer) [short int] <br>
- *'l' (integer) [long int] <br>
- *'c' (string of length 1) [char] <br>
- *'d' (float) [double] <br>
- *'f' (float) [float] <br><br>
- *'(items)' (tuple) [matching-items] <br>
- *'[items]' (list) [matching-items] <br>
-
- *It recognizes a set of format units similar to the ones recognized by PyArg_ParseTuple(),
- *but the arguments (which are input to the function, not output) must not be pointers, just 
- *values. It returns a new Python object, suitable for returning from a C function called from Python. 
- *<br>
- *One difference with PyArg_ParseTuple(): while the latter requires its first argument to be a 
- *tuple (since Python argument lists are always represented as tuples internally), BuildValue() 
- *does not always build a tuple. It builds a tuple only if its format string contains two or more 
- *format units. If the format string is empty, it returns None; if it contains exactly one format unit, 
- *it returns whatever object is described by that format unit. To force it to return a tuple of size 0 
- *or one, parenthesize the format string. <br>
- *Examples (to the left the call, to the right the resulting Python value): 
- * <br>
- *examples:<br>
- *    buildPyValue("")                        None <br>
- *    buildPyValue("i", 123)                  123  <br>
- *    buildPyValue("iii", 123, 456, 789)      (123, 456, 789)<br>
- *    buildPyValue("s", "hello")              'hello'<br>
- *    buildPyValue("ss", "hello", "world")    ('hello', 'world')<br>
- *    buildPyValue("s#", "hello", 4)          'hell'<br>
- *    buildPyValue("()")                      ()<br>
- *    buildPyValue("(i)", 123)                (123,)<br>
- *    buildPyValue("(ii)", 123, 456)          (123, 456)<br>
- *    buildPyValue("(i,i)", 123, 456)         (123, 456)<br>
- *    buildPyValue("[i,i]", 123, 456)         [123, 456]<br>
- *    buildPyValue("{s:i,s:i}",<br>
- *                  "abc", 123, "def", 456)    {'abc': 123, 'def': 456}<br>
- *    buildPyValue("((ii)(ii)) (ii)",<br>
- *                  1, 2, 3, 4, 5, 6)          (((1, 2), (3, 4)), (5, 6))<br>
- */
-
-	PyValue *PySession::buildPyValue(const std::string &format,...) {
-		PyValue *retpyval;
-		PyObject *val;
-		va_list args;
-		va_start(args,format);
-		val = Py_VaBuildValue((char*)format.c_str(), args);
-		if (val) {
-			retpyval = new PyValue(val);
-			Py_DECREF(val);
-			m_values.push_back(retpyval);
-		}
-		va_end(args);
-		return retpyval;
-	}
-
-	/** \example buildpyvalue_ex.cpp
- * This example shows how to use BuildPyValue() to create a new PyValue instance.
- * In the example 3 values are build a number, a string and a tuple.
- * Note that m_pySession is a classmember of PySession type.
- */
-	/** \example pyclass_ex.cpp
- * This example creates an instance of a simple HTTP reader and retrieves the source
- * google's mainpage
- */
-	/** \example callfunction_ex.cpp
- * The example shows how to call a free python function. In this case the function
- * "getcwd()" (get current working directory) from the module "os". "os" is one of the
- * native python modules - see module index on python.org for more information.
- */
-	/** \example pyerror_ex.cpp
- * This example demonstrates how to work with python exceptions through the TRPyEmb
- * framework. The PySession is created with autoalert disabled and thereby leaving
- * error notification in in the API users hand.
- */
-	/** \example pypath_ex.cpp
- * This example demonstrates how to alter python sys.path
- */
-}
+#include "pysession.h"
+#include "pyclass.h"
+#include "pyfunction.h"
+#include "pyerror.h"
+#include "pygil.h"
+#include "pycallqueue.h"
+#include "pyresultscope.h"
+#include "pyunicode.h"
+
+#include <Python.h>
+#include <pythread.h>
+#include <string>
+#include <iostream>
+#include <sstream>
+
+
+namespace PyEmb {
+	/** \brief Constructor
+
+  @param autoAlert Automatically display python exceptions
+
+PySession constructor. 
+*/
+	PySession::PySession(bool autoAlert) {
+		m_sysModsLoaded = false;
+		m_autoAlert = autoAlert;
+		m_lazyConversion = false;
+		m_moduleLookups = 0;
+		m_moduleLookupHits = 0;
+		m_callQueue = NULL;
+		m_pool = NULL;
+		Py_Initialize();
+		PyEval_InitThreads();
+		m_threadKey = PyThread_create_key();
+		m_threadLock = PyThread_allocate_lock();
+		// Release the GIL until the session is called
+		m_threadState = PyEval_SaveThread();
+	}
+
+	/* Worker session of a PyInterpreterPool. Everything runs on the interpreter thread
+	   of the call queue, which creates and ends a sub interpreter of its own */
+	PySession::PySession(PyInterpreterPool *pool, bool autoAlert) {
+		m_sysModsLoaded = false;
+		m_autoAlert = autoAlert;
+		m_lazyConversion = false;
+		m_moduleLookups = 0;
+		m_moduleLookupHits = 0;
+		m_pool = pool;
+		m_threadState = NULL;
+		m_threadKey = PyThread_create_key();
+		m_threadLock = PyThread_allocate_lock();
+		m_callQueue = new PyCallQueue(this);
+	}
+
+	/** \brief Destructor */
+	PySession::~PySession() {
+		// Let the interpreter thread finish queued calls before taking the GIL back
+		delete m_callQueue;
+		if (!m_pool) {
+			PyEval_RestoreThread(m_threadState);
+			release();
+		}
+		PyThread_delete_key(m_threadKey);
+		PyThread_free_lock(m_threadLock);
+
+		// Finalize python session
+		if (!m_pool)
+			Py_Finalize();
+	}
+
+	/* Release everything held by the session, the GIL must be held */
+	void PySession::release() {
+		PyClassArray::iterator it_inst = m_instances.begin();
+		for (; it_inst != m_instances.end(); ++it_inst) {
+			delete *it_inst;
+		}
+
+		PyFunctionArray::iterator it_func = m_functions.begin();
+		for (; it_func != m_functions.end(); ++it_func) {
+			delete *it_func;
+		}
+
+		PyThreadDataArray::iterator it_thread = m_threads.begin();
+		for (; it_thread != m_threads.end(); ++it_thread) {
+			PyValueArray::iterator it_val = (*it_thread)->values.begin();
+			for (; it_val!=(*it_thread)->values.end(); ++it_val) {
+				delete *it_val;
+			}
+			PyFutureArray::iterator it_fut = (*it_thread)->futures.begin();
+			for (; it_fut!=(*it_thread)->futures.end(); ++it_fut) {
+				delete *it_fut;
+			}
+			delete *it_thread;
+		}
+
+		PyModuleMap::iterator it_mod = m_modules.begin();
+		for (; it_mod != m_modules.end(); ++it_mod) {
+			Py_DECREF(it_mod->second);
+		}
+	}
+
+	/* Called on the interpreter thread before running calls. Creates the sub interpreter
+	   of a pool worker, which then is the interpreter PyGILLock selects in this thread */
+	void PySession::startInterpreter() {
+		if (!m_pool)
+			return;
+		PyEval_AcquireLock();
+		PyThreadState *threadState = Py_NewInterpreter();
+		m_threadState = PyEval_SaveThread();
+		if (!threadState)
+			std::cerr << "Cannot create python sub interpreter" << std::endl;
+	}
+
+	/* Called on the interpreter thread when the queue has been stopped */
+	void PySession::endInterpreter() {
+		if (!m_pool || !m_threadState)
+			return;
+		PyEval_RestoreThread(m_threadState);
+		release();
+		Py_EndInterpreter(m_threadState);
+		PyEval_ReleaseLock();
+	}
+
+	/** \brief Manually delete CallFunction() resultbuffer.
+EmptyResultBuffer deletes all PyValue's and PyFuture's administrated by PySession for the calling thread.
+Calling this actively requieres caution, since it deletes the PyValues you may be using currently.
+Futures of asynchronous calls which haven't completed yet are waited for.
+*/
+	void PySession::emptyResultBuffer() {
+		// Pending futures wait for the interpreter thread, which needs the GIL
+		PyFutureArray &futures = threadData()->futures;
+		PyFutureArray::iterator it_fut = futures.begin();
+		for (; it_fut!=futures.end(); ++it_fut) {
+			delete *it_fut;
+		}
+		futures.erase(futures.begin(),futures.end());
+
+		// Results converted from python release their python objects
+		PyGILLock lock;
+		PyValueArray &values = threadData()->values;
+		PyValueArray::iterator it_val = values.begin();
+		for (; it_val!=values.end(); ++it_val) {
+			delete *it_val;
+		}
+		values.erase(values.begin(),values.end());
+	}
+
+	/* Result buffer and last error of the calling thread, created on first use */
+	PyThreadData *PySession::threadData() {
+		PyThreadData *data = (PyThreadData *) PyThread_get_key_value(m_threadKey);
+		if (!data) {
+			data = new PyThreadData;
+			PyThread_set_key_value(m_threadKey,data);
+			PyThread_acquire_lock(m_threadLock,WAIT_LOCK);
+			m_threads.push_back(data);
+			PyThread_release_lock(m_threadLock);
+		}
+		return data;
+	}
+
+	/* Convert the result of a call, owned by the innermost result scope of the calling thread
+	   if there is one, otherwise by buffer or the thread's result buffer */
+	PyValue *PySession::storeResult(PyObject *pValue) {
+		PyThreadData *data = threadData();
+		if (data->scope)
+			return data->scope->newValue(pValue,m_lazyConversion);
+		PyValue *result = new PyValue(pValue,m_lazyConversion);
+		data->values.push_back(result);
+		return result;
+	}
+
+	void PySession::storeFuture(PyFuture *future) {
+		PyThreadData *data = threadData();
+		if (data->scope)
+			data->scope->storeFuture(future);
+		else
+			data->futures.push_back(future);
+	}
+
+	/** \brief Import a python module. The python interpreter searches for the module
+in the python sys.path.
+
+  @param ModuleName Module to import - MyModule imports MyModule.py, package.MyModule imports
+  MyModule.py from package
+
+A module which has already been imported by the session is not imported again.
+
+The default sys.path is as follows:
+<br>
+  PY_HOME = path to TRPyEmbxx.dll <br>
+  PY_HOME <br>
+  PY_HOME/PyModules<br>
+  PY_HOME/PyModules/site-packages <br>
+  PY_HOME/PyScripts<br>
+  PY_HOME/PyScripts/<running processname> (fx. PY_HOME/PyScripts/TRExport)<br>
+<br>
+Important modules:<br>
+  sys  <br>
+  os  <br>
+  os.path  <br>
+  odbc  <br>
+  cx_Oracle  <br>
+  <br>
+  <a href="http://www.python.org/doc/current/modindex.html">Python module index</a>  <br>
+  <a href="http://www.python.org/topics/database/">Python database api</a>  <br>
+  <br>
+*/
+	bool PySession::importModule(const std::string &moduleName) {
+		PyGILLock lock;
+		if (loadedModule(moduleName))
+			return true;
+		PyObject *pModule = loadModule(moduleName);
+		if (pModule) {
+			m_modules[moduleName] = pModule;
+			return true;
+		}
+		return false;
+	}
+
+	/** \brief Make the C++ functions of module importable by python, see PyHostModule.
+Functions added to the module later are made importable by adding it again.
+
+  @param module Module to add, which must exist as long as the session
+
+*/
+	bool PySession::addModule(PyHostModule *module) {
+		PyGILLock lock;
+		if (module->install())
+			return true;
+		std::ostringstream doingwhat;
+		doingwhat << "Adding module " << module->name() << std::endl;
+		reportError(doingwhat.str());
+		return false;
+	}
+
+	/** \brief Number of module lookups done by the session.
+Every function call, class instantiation and import by module name counts as a lookup.
+*/
+	long PySession::moduleLookups() const {
+		return m_moduleLookups;
+	}
+
+	/** \brief Number of module lookups which found an already imported module */
+	long PySession::moduleLookupHits() const {
+		return m_moduleLookupHits;
+	}
+
+	/** \brief Fraction of module lookups which found an already imported module (0 when no lookups were done) */
+	double PySession::moduleHitRate() const {
+		if (m_moduleLookups == 0)
+			return 0.0;
+		return double(m_moduleLookupHits)/m_moduleLookups;
+	}
+
+	/** \brief Enable/disable autoalert for the session being. This meens that python exceptions which
+occure while importing modules, calling functions, creating class instances etc. will be
+displayed immediately.
+
+  @param autoalert True/false enable/disable repectively
+
+*/
+	void PySession::setAutoAlertEnabled(bool autoalert) {
+		m_autoAlert = autoalert;
+	}
+
+	/** \brief Test autoalert enabled/disabled */
+	bool PySession::autoAlertEnabled() {
+		return m_autoAlert;
+	}
+
+	/** \brief Enable/disable lazy conversion of results. Tuples, lists and dicts in the results of
+later calls keep a reference to the python object and are converted one level at a time when they
+are first read, see PyValue. Useful when only part of large results is read.
+
+  @param lazy True/false enable/disable repectively
+
+Lazy results, and copies of them, must be released before the session is destroyed.
+*/
+	void PySession::setLazyConversionEnabled(bool lazy) {
+		m_lazyConversion = lazy;
+	}
+
+	/** \brief Test lazy conversion enabled/disabled */
+	bool PySession::lazyConversionEnabled() {
+		return m_lazyConversion;
+	}
+
+	/** \brief Create a new instance of a class. The class must be declared
+in one of the imported modules.
+See PyClass for information on calling class methods.
+
+  @param ModuleName Python module declaring the class
+  @param ClassName Class to instantiate 
+  @param Args Constructor arguments (null meens no arguments is passed)
+
+*/
+	PyClass* PySession::newInstance(const std::string &moduleName, const std::string &className,PyValue *args) {
+		PyGILLock lock;
+		PyObject *pArgs = pyValueToPyObject(args,true);
+		PyObject *pInstance = createInstance(moduleName,className,pArgs);
+		Py_XDECREF(pArgs);
+		if (pInstance) {
+			PyClass *pyClassInstance = new PyClass(pInstance,this);
+			m_instances.push_back(pyClassInstance);
+			return pyClassInstance;
+		}
+		return NULL;
+	}
+
+
+	/** \brief Add an absolute path to python sys.path.
+Only one path at the time
+
+  @param path The absolute path to be added
+
+You can display the current path by calling ShowPath()
+
+*/
+	void PySession::addToPyPath(const std::string &path) {
+		PyGILLock lock;
+		PyObject *syspath = PySys_GetObject((char *) "path");
+		PyObject *pathstr = PyString_FromString(path.c_str());
+		PyList_Append(syspath,pathstr);
+		Py_XDECREF(pathstr);
+	}
+
+	/** \brief Create and display a messagebox containing
+the current python sys.path.
+
+  Python sys.path determins in which order the python
+  interpreter will search for modules.
+  You can add elements to python sys.path by calling
+  AddToPyPath().
+*/
+	void PySession::showPath() {
+		PyGILLock lock;
+		PyObject *syspath = PySys_GetObject((char *) "path");
+		PyObject *seperator = PyString_FromString(";");
+		PyObject *pathstr = _PyString_Join(seperator,syspath);
+		Py_XDECREF(seperator);
+
+		std::ostringstream newpath;
+		newpath << (const char*) PyString_AsString(pathstr);
+
+		Py_XDECREF(pathstr);
+		std::cout << newpath.str();
+	}
+
+
+#define TRACEBACK_FETCH_ERROR(what) {errMsg = what; goto done;}
+
+	char *pyTraceback_AsString(PyObject *exc_tb) {
+		char *errMsg = NULL; /* holds a local error message */
+		char *result = NULL; /* a valid, allocated result. */
+		PyObject *modStringIO = NULL;
+		PyObject *modTB = NULL;
+		PyObject *obFuncStringIO = NULL;
+		PyObject *obStringIO = NULL;
+		PyObject *obFuncTB = NULL;
+		PyObject *argsTB = NULL;
+		PyObject *obResult = NULL;
+
+		/* Import the modules we need - cStringIO and traceback */
+		modStringIO = PyImport_ImportModule("cStringIO");
+		if (modStringIO==NULL)
+			TRACEBACK_FETCH_ERROR((char *) "cant import cStringIO\n");
+
+		modTB = PyImport_ImportModule("traceback");
+		if (modTB==NULL)
+			TRACEBACK_FETCH_ERROR((char *) "cant import traceback\n");
+		/* Construct a cStringIO object */
+		obFuncStringIO = PyObject_GetAttrString(modStringIO, "StringIO");
+		if (obFuncStringIO==NULL)
+			TRACEBACK_FETCH_ERROR((char *) "cant find cStringIO.StringIO\n");
+		obStringIO = PyObject_CallObject(obFuncStringIO, NULL);
+		if (obStringIO==NULL)
+			TRACEBACK_FETCH_ERROR((char *) "cStringIO.StringIO() failed\n");
+		/* Get the traceback.print_exception function, and call it. */
+		obFuncTB = PyObject_GetAttrString(modTB, "print_tb");
+		if (obFuncTB==NULL)
+			TRACEBACK_FETCH_ERROR((char *) "cant find traceback.print_tb\n");
+
+		argsTB = Py_BuildValue("OOO",
+							   exc_tb  ? exc_tb  : Py_None,
+							   Py_None,
+							   obStringIO);
+		if (argsTB==NULL)
+			TRACEBACK_FETCH_ERROR((char *) "cant make print_tb arguments\n");
+
+		obResult = PyObject_CallObject(obFuncTB, argsTB);
+		if (obResult==NULL)
+			TRACEBACK_FETCH_ERROR((char *) "traceback.print_tb() failed\n");
+		/* Now call the getvalue() method in the StringIO instance */
+		Py_DECREF(obFuncStringIO);
+		obFuncStringIO = PyObject_GetAttrString(obStringIO, "getvalue");
+		if (obFuncStringIO==NULL)
+			TRACEBACK_FETCH_ERROR((char *) "cant find getvalue function\n");
+		Py_DECREF(obResult);
+		obResult = PyObject_CallObject(obFuncStringIO, NULL);
+		if (obResult==NULL)
+			TRACEBACK_FETCH_ERROR((char *) "getvalue() failed.\n");
+
+		/* And it should be a string all ready to go - duplicate it. */
+		if (!PyString_Check(obResult))
+			TRACEBACK_FETCH_ERROR((char *) "getvalue() did not return a string\n");
+
+		{ // a temp scope so I can use temp locals.
+			char *tempResult = PyString_AsString(obResult);
+			result = (char *)PyMem_Malloc(strlen(tempResult)+1);
+			if (result==NULL)
+				TRACEBACK_FETCH_ERROR((char *) "memory error duplicating the traceback string\n");
+
+			strcpy(result, tempResult);
+		} // end of temp scope.
+		done:
+		/* All finished - first see if we encountered an error */
+		if (result==NULL && errMsg != NULL) {
+			result = (char *)PyMem_Malloc(strlen(errMsg)+1);
+			if (result != NULL)
+				/* if it does, not much we can do! */
+				strcpy(result, errMsg);
+		}
+		Py_XDECREF(modStringIO);
+		Py_XDECREF(modTB);
+		Py_XDECREF(obFuncStringIO);
+		Py_XDECREF(obStringIO);
+		Py_XDECREF(obFuncTB);
+		Py_XDECREF(argsTB);
+		Py_XDECREF(obResult);
+		return result;
+	}
+
+	void PySession::storeError(PyError *error) {
+		PyObject *err_type, *err_value, *err_traceback;
+		int have_error = PyErr_Occurred() ? 1 : 0;
+		if (have_error) {
+			PyErr_Fetch(&err_type, &err_value, &err_traceback);
+		}
+		else {
+			return;
+		}
+		error->setTraceback(pyTraceback_AsString(err_traceback));
+
+		PyObject *temp = PyObject_Str(err_type);
+		if (temp) {
+			error->setException(PyString_AsString(temp));
+			Py_DECREF(temp);
+		}
+		else {
+			error->setException("Can't convert exception to a string!");
+		}
+		if (err_value != NULL) {
+			temp = PyObject_Str(err_value);
+			if (temp) {
+				error->setExceptionValue(PyString_AsString(temp));
+				Py_DECREF(temp);
+			}
+			else {
+				error->setExceptionValue("Can't convert exception value to a string!");
+			}
+		}
+	}
+
+	/* Store the pending python exception as the last error of the calling thread */
+	void PySession::reportError(const std::string &doingWhat) {
+		PyError *error = lastError();
+		error->setDoingWhat(doingWhat);
+		storeError(error);
+		if (autoAlertEnabled())
+			raiseErrorMessage();
+	}
+
+	/** \brief Retrieve a pointer
+to the last python exception (error) which has occured in the calling thread.
+*/
+	PyError *PySession::lastError() {
+		return &threadData()->lastError;
+	}
+
+
+	PyObject* PySession::loadModule(const std::string &moduleName) {
+		PyObject *pName, *pModule;
+
+		pName = PyString_FromString(moduleName.c_str());
+		/* Error checking of pName left out */
+
+		pModule = PyImport_Import(pName);
+		if (pModule == NULL) {
+			std::ostringstream doingwhat;
+			doingwhat << "Importing " << moduleName << std::endl;
+
+			reportError(doingwhat.str());
+			if (autoAlertEnabled()) {
+				showPath();
+			}
+			return NULL;
+		}
+		Py_XDECREF(pName);
+		return pModule;
+	}
+
+
+	/** \brief This method creates and displays a messagebox
+containing information about the latest python exception (error)
+
+This method is called automatically when autoAlert is enabled - 
+SetAutoAlertEnabled().
+*/
+	void PySession::raiseErrorMessage()
+	{
+		std::ostringstream error;
+
+		error << "Python exception occured while:" << std::endl;
+		error << lastError()->doingWhat() << std::endl;
+		error << lastError()->traceback() << lastError()->exception() << std::endl;
+		error << lastError()->exceptionValue() << std::endl;
+
+		std::cout << error.str();
+	}
+
+	PyObject* PySession::loadedModule(const std::string &moduleName) {
+		m_moduleLookups++;
+		PyModuleMap::iterator it_mod = m_modules.find(moduleName);
+		if (it_mod != m_modules.end()) {
+			m_moduleLookupHits++;
+			return it_mod->second;
+		}
+		return NULL;
+	}
+
+	PyObject* PySession::module(const std::string &moduleName) {
+		PyObject *pModule = loadedModule(moduleName);
+		if (!pModule) {
+			pModule = loadModule(moduleName);
+			if (!pModule)
+				return NULL;
+			// The import runs python code, which lets other threads import the module meanwhile
+			PyModuleMap::iterator it_mod = m_modules.find(moduleName);
+			if (it_mod != m_modules.end()) {
+				Py_DECREF(pModule);
+				return it_mod->second;
+			}
+			m_modules[moduleName] = pModule;
+		}
+		return pModule;
+	}
+
+	PyObject* PySession::createInstance(const std::string &moduleName,const std::string &className,PyObject *args) {
+		PyObject *pModule, *pDict, *pClass, *pInstance;
+		pModule = pDict = pClass = pInstance = NULL;
+
+		pModule = module(moduleName);
+
+		if (pModule) {
+			// Module found now attempt to make an instance
+			pDict = PyModule_GetDict(pModule);                        // Try to load module dictionary
+			if (!pDict)
+				return NULL;
+			else {
+				pClass = PyDict_GetItemString(pDict, (char *) className.c_str());     // Get class reference
+				if (pClass) {
+					pInstance = PyInstance_New(pClass,args,NULL);           // Create it
+				}
+			}
+			if (!pInstance)
+			{
+				std::ostringstream doingwhat;
+				doingwhat << "Creating instance of class " << className << " from module " << moduleName << std::endl;
+				reportError(doingwhat.str());
+			}
+		}
+		return pInstance;
+	}
+
+	void PySession::loadSysMods() {
+		if (m_sysModsLoaded)
+			return;
+		if (importModule("sys") &&
+			importModule("os"))
+			m_sysModsLoaded = true;
+	}
+
+
+	/** \brief Call a python function
+from an imported module using PyValue as return type and 
+argument passing. Use BuildPyValue() to create arguments.
+
+  @param Module Module containing function
+  @param Function Function to be called
+  @param Arguments Arguments being passed (NULL meens no arguments)
+
+*/
+	PyValue *PySession::callFunction(const std::string &moduleName, const std::string &functionName, PyValue *args) {
+		PyGILLock lock;
+		PyValue *result = NULL;
+		PyObject *pFunc;
+		PyObject *pArgs, *pValue;
+
+		pFunc = lookupFunction(moduleName,functionName);
+		/* pFunc: Borrowed reference */
+		if (pFunc) {
+			pArgs = pyValueToPyObject(args,true);
+			pValue = PyObject_CallObject(pFunc, pArgs);
+			if (pValue != NULL) {
+				result = storeResult(pValue);
+				Py_DECREF(pValue);
+			}
+			else {
+				std::ostringstream doingwhat;
+				doingwhat << "Calling function " << functionName << " in module " << moduleName << std::endl;
+				reportError(doingwhat.str());
+			}
+			Py_XDECREF(pArgs);
+		}
+		return result;
+	}
+	/** \brief Call python function
+Like CallFunction() only it takes a PyObject as argument
+PyValueToPyObject() can be used to convert a PyValue to a PyObject.
+
+  @param Module Module containing function
+  @param Function Function to be called
+  @param pArgs Arguments being passed (NULL meens no arguments)
+
+*/
+	PyValue *PySession::callFunctionObj(const std::string &moduleName, const std::string &functionName, PyObject *pArgs) {
+		PyGILLock lock;
+		PyValue *result = NULL;
+		PyObject *pFunc;
+		PyObject *pValue;
+
+		pFunc = lookupFunction(moduleName,functionName);
+		/* pFunc: Borrowed reference */
+		if (pFunc) {
+			pValue = PyObject_CallObject(pFunc, pArgs);
+			if (pValue != NULL) {
+				result = storeResult(pValue);
+				Py_DECREF(pValue);
+			}
+			else {
+				std::ostringstream doingwhat;
+				doingwhat << "Calling function " << functionName << " in module " << moduleName << std::endl;
+				reportError(doingwhat.str());
+			}
+			Py_XDECREF(pArgs);
+		}
+		return result;
+	}
+
+	/** \brief Call python function and return the result by value
+Like CallFunction(), only the result is not stored by the session - no PyValue is allocated for it and
+it lives as long as the caller keeps it. A python exception is described by the error of the result
+and reported through lastError() as usual.
+
+  @param Module Module containing function
+  @param Function Function to be called
+  @param args Arguments being passed (NULL meens no arguments)
+
+*/
+	PyResult PySession::callFunctionResult(const std::string &moduleName, const std::string &functionName, PyValue *args) {
+		PyGILLock lock;
+		PyResult result;
+		std::ostringstream doingwhat;
+		doingwhat << "Calling function " << functionName << " in module " << moduleName << std::endl;
+		PyObject *pFunc = lookupFunction(moduleName,functionName);
+		/* pFunc: Borrowed reference */
+		if (pFunc) {
+			PyObject *pArgs = pyValueToPyObject(args,true);
+			callResult(pFunc,pArgs,doingwhat.str(),result);
+			Py_XDECREF(pArgs);
+		}
+		else {
+			result.error.setDoingWhat(doingwhat.str());
+			result.error.setException("LookupError");
+			result.error.setExceptionValue("Cannot find function \"" + functionName + "\" in module " + moduleName);
+		}
+		return result;
+	}
+
+	/** \brief Call python function and return the result unconverted
+Like CallFunction(), only the result is held by a PyRef instead of being converted to a PyValue. Pass it
+on to other calls with the PyRefList overload, or convert it with PyRef::value(). A python exception
+returns a null PyRef and is reported through lastError().
+
+  @param Module Module containing function
+  @param Function Function to be called
+  @param args Arguments being passed (NULL meens no arguments)
+
+*/
+	PyRef PySession::callFunctionRef(const std::string &moduleName, const std::string &functionName, PyValue *args) {
+		PyGILLock lock;
+		PyObject *pFunc = lookupFunction(moduleName,functionName);
+		/* pFunc: Borrowed reference */
+		if (!pFunc)
+			return PyRef();
+		std::ostringstream doingwhat;
+		doingwhat << "Calling function " << functionName << " in module " << moduleName << std::endl;
+		PyObject *pArgs = pyValueToPyObject(args,true);
+		PyRef result = callRef(pFunc,pArgs,doingwhat.str());
+		Py_XDECREF(pArgs);
+		return result;
+	}
+
+	/** \brief Call python function with python objects as arguments
+Like the other callFunctionRef(), only every element of args is passed as one argument without any
+conversion. A null PyRef is passed as None. Use pyValueToPyRef() to pass a PyValue.
+
+  @param Module Module containing function
+  @param Function Function to be called
+  @param args Arguments being passed
+
+*/
+	PyRef PySession::callFunctionRef(const std::string &moduleName, const std::string &functionName, const PyRefList &args) {
+		PyGILLock lock;
+		PyObject *pFunc = lookupFunction(moduleName,functionName);
+		/* pFunc: Borrowed reference */
+		if (!pFunc)
+			return PyRef();
+		std::ostringstream doingwhat;
+		doingwhat << "Calling function " << functionName << " in module " << moduleName << std::endl;
+		PyObject *pArgs = refArguments(args);
+		PyRef result = callRef(pFunc,pArgs,doingwhat.str());
+		Py_DECREF(pArgs);
+		return result;
+	}
+
+	/** \brief Call python function and iterate the result
+The result, fx. a generator or a list, is iterated by a PyIterator which pulls and converts one item at
+a time, so results of any length are read in constant memory. A python exception, from the call or while
+iterating, ends the iteration and is reported through lastError().
+
+  @param Module Module containing function
+  @param Function Function to be called
+  @param args Arguments being passed (NULL meens no arguments)
+
+*/
+	PyIterator PySession::callFunctionIter(const std::string &moduleName, const std::string &functionName, PyValue *args) {
+		return PyIterator(this,callFunctionRef(moduleName,functionName,args));
+	}
+
+	/* Call with the GIL held, a python exception is reported and returns a null PyRef */
+	PyRef PySession::callRef(PyObject *callable, PyObject *pArgs, const std::string &doingWhat) {
+		PyObject *pValue = PyObject_CallObject(callable,pArgs);
+		if (!pValue)
+			reportError(doingWhat);
+		return PyRef::steal(pValue);
+	}
+
+	/* Argument tuple of the objects of args */
+	PyObject *PySession::refArguments(const PyRefList &args) {
+		PyObject *pArgs = PyTuple_New(args.size());
+		for (size_t i=0;i<args.size();i++) {
+			PyObject *pArg = args[i].m_object ? args[i].m_object : Py_None;
+			Py_INCREF(pArg);
+			PyTuple_SET_ITEM(pArgs,i,pArg);
+		}
+		return pArgs;
+	}
+
+	/* Call of the typed call(), with the GIL held. Steals pArgs and returns a new reference or NULL */
+	PyObject *PySession::typedCall(const std::string &moduleName, const std::string &functionName, PyObject *pArgs) {
+		PyObject *pValue = NULL;
+		// An argument which failed to convert is left NULL in the argument tuple
+		for (Py_ssize_t i=0;i<PyTuple_GET_SIZE(pArgs);i++) {
+			if (!PyTuple_GET_ITEM(pArgs,i)) {
+				reportArgumentError(functionName);
+				Py_DECREF(pArgs);
+				return NULL;
+			}
+		}
+		PyObject *pFunc = lookupFunction(moduleName,functionName);
+		/* pFunc: Borrowed reference */
+		if (pFunc) {
+			pValue = PyObject_CallObject(pFunc,pArgs);
+			if (!pValue) {
+				std::ostringstream doingwhat;
+				doingwhat << "Calling function " << functionName << " in module " << moduleName << std::endl;
+				reportError(doingwhat.str());
+			}
+		}
+		Py_DECREF(pArgs);
+		return pValue;
+	}
+
+	/* An argument of a typed call doesn't convert to python */
+	void PySession::reportArgumentError(const std::string &functionName) {
+		std::string doingWhat = "Converting arguments of function " + functionName;
+		if (PyErr_Occurred()) {
+			reportError(doingWhat);
+			return;
+		}
+		PyError *error = lastError();
+		error->setDoingWhat(doingWhat);
+		error->setException("TypeError");
+		error->setExceptionValue("Argument conversion failed");
+		error->setTraceback("");
+		if (autoAlertEnabled())
+			raiseErrorMessage();
+	}
+
+	/* The result of a typed call doesn't convert to the requested type */
+	void PySession::reportConversionError(PyObject *pValue, const std::string &functionName) {
+		PyError *error = lastError();
+		error->setDoingWhat("Converting result of function " + functionName);
+		error->setException("TypeError");
+		error->setExceptionValue(std::string("Cannot convert ") + pValue->ob_type->tp_name + " to the requested type");
+		error->setTraceback("");
+		if (autoAlertEnabled())
+			raiseErrorMessage();
+	}
+
+	/** \brief Call a python function once for every element in args
+The function is looked up once and called with each element as argument, like
+CallFunction(). The argument tuple is reused between calls when python has not
+kept a reference to it.
+
+  @param Module Module containing function
+  @param Function Function to be called
+  @param args One argument value per call
+
+Returns one PyBatchResult per element of args, in the same order. A call raising a
+python exception is reported in its own element and does not stop the batch.
+If the function can't be found an empty array is returned.
+*/
+	PyBatchResultArray PySession::callFunctionBatch(const std::string &moduleName, const std::string &functionName, const PyValueList &args) {
+		PyGILLock lock;
+		PyObject *pFunc = lookupFunction(moduleName,functionName);
+		/* pFunc: Borrowed reference */
+		if (!pFunc)
+			return PyBatchResultArray();
+		std::ostringstream doingwhat;
+		doingwhat << "Calling function " << functionName << " in module " << moduleName << std::endl;
+		return callBatch(pFunc,args,doingwhat.str());
+	}
+
+	PyBatchResultArray PySession::callBatch(PyObject *callable, const PyValueList &args, const std::string &doingWhat) {
+		PyBatchResultArray results(args.size());
+		PyObject *pArgs = NULL;
+		for (size_t i=0;i<args.size();i++) {
+			pArgs = argumentTuple(pArgs,&args[i]);
+			callResult(callable,pArgs,doingWhat,results[i]);
+		}
+		Py_XDECREF(pArgs);
+		return results;
+	}
+
+	/* Call callable and convert the returned object, or the exception, straight into result */
+	void PySession::callResult(PyObject *callable, PyObject *pArgs, const std::string &doingWhat, PyResult &result) {
+		PyObject *pValue = PyObject_CallObject(callable, pArgs);
+		if (pValue != NULL) {
+			result.value.setValue_FromPyObject(pValue,m_lazyConversion);
+			result.ok = true;
+			Py_DECREF(pValue);
+		}
+		else {
+			result.error.setDoingWhat(doingWhat);
+			storeError(&result.error);
+			*lastError() = result.error;
+			if (autoAlertEnabled())
+				raiseErrorMessage();
+		}
+	}
+
+	/* Fill the argument tuple of the previous call with value, or build a new one if
+	   python still holds a reference to it or the number of arguments differs */
+	PyObject *PySession::argumentTuple(PyObject *pArgs, const PyValue *value) {
+		if (pArgs && pArgs->ob_refcnt == 1) {
+			if (value->valueType() == PyValue::PyTupleType) {
+				const PyTuple &tuple = value->valueAsTuple();
+				if (PyTuple_GET_SIZE(pArgs) == tuple.size()) {
+					for (int i=0;i<tuple.size();i++) {
+						PyTuple_SetItem(pArgs,i,pyValueToPyObject(&tuple.value(i)));
+					}
+					return pArgs;
+				}
+			}
+			else if (value->valueType() != PyValue::PyNullType && PyTuple_GET_SIZE(pArgs) == 1) {
+				PyTuple_SetItem(pArgs,0,pyValueToPyObject(value));
+				return pArgs;
+			}
+		}
+		Py_XDECREF(pArgs);
+		return pyValueToPyObject(value,true);
+	}
+
+	/** \brief Call a python function asynchronously
+Queues the call for the session's interpreter thread and returns without waiting for it.
+The returned PyFuture holds the result once the call has completed.
+
+  @param Module Module containing function
+  @param Function Function to be called
+  @param Arguments Arguments being passed (NULL meens no arguments), copied before returning
+  @param callback Called on the interpreter thread when the call has completed (NULL meens no callback)
+  @param userData Passed to callback
+
+*/
+	PyFuture *PySession::callFunctionAsync(const std::string &moduleName, const std::string &functionName, PyValue *args,
+		PyFutureCallback callback, void *userData) {
+		PyAsyncCall *call = new PyAsyncCall;
+		call->moduleName = moduleName;
+		call->kind = PyAsyncCall::FunctionCall;
+		call->functionName = functionName;
+		call->instance = NULL;
+		return queueCall(call,args,callback,userData);
+	}
+
+	/** \brief Retrieve the counters of the asynchronous call queue.
+Use depth and wait times to see whether the interpreter thread keeps up with the calls being queued.
+*/
+	PyAsyncStats PySession::asyncStats() {
+		PyThread_acquire_lock(m_threadLock,WAIT_LOCK);
+		PyCallQueue *queue = m_callQueue;
+		PyThread_release_lock(m_threadLock);
+		if (!queue)
+			return PyAsyncStats();
+		return queue->stats();
+	}
+
+	PyFuture *PySession::queueCall(PyAsyncCall *call, PyValue *args, PyFutureCallback callback, void *userData) {
+		call->hasArgs = args != NULL;
+		if (args)
+			call->args = *args;
+		call->future = new PyFuture(callback,userData);
+		storeFuture(call->future);
+
+		PyThread_acquire_lock(m_threadLock,WAIT_LOCK);
+		if (!m_callQueue)
+			m_callQueue = new PyCallQueue(this);
+		PyThread_release_lock(m_threadLock);
+
+		PyFuture *future = call->future;
+		m_callQueue->push(call);
+		return future;
+	}
+
+	/* Run a queued call on the interpreter thread and complete its future */
+	void PySession::runAsyncCall(PyAsyncCall *call) {
+		PyFuture *future = call->future;
+		{
+			PyGILLock lock;
+			std::ostringstream doingwhat;
+			PyObject *pFunc = NULL;
+			switch (call->kind) {
+			case PyAsyncCall::ModuleImport:
+				future->m_ok = importModule(call->moduleName);
+				break;
+			case PyAsyncCall::PathAppend:
+				addToPyPath(call->moduleName);
+				future->m_ok = true;
+				break;
+			case PyAsyncCall::InstanceCreation:
+				future->m_instance = newInstance(call->moduleName,call->functionName,call->hasArgs ? &call->args : NULL);
+				future->m_ok = future->m_instance != NULL;
+				break;
+			case PyAsyncCall::MethodCall:
+				doingwhat << "Calling method " << call->functionName << std::endl;
+				pFunc = PyObject_GetAttrString(call->instance->m_instance, call->functionName.c_str());
+				break;
+			case PyAsyncCall::FunctionCall:
+				doingwhat << "Calling function " << call->functionName << " in module " << call->moduleName << std::endl;
+				pFunc = lookupFunction(call->moduleName,call->functionName);
+				Py_XINCREF(pFunc);
+				if (!pFunc) {
+					// No python exception is pending when the function is missing
+					PyError *error = lastError();
+					error->setDoingWhat(doingwhat.str());
+					error->setException("LookupError");
+					error->setExceptionValue("Cannot find function \"" + call->functionName + "\" in module " + call->moduleName);
+				}
+				break;
+			}
+
+			if (call->kind == PyAsyncCall::MethodCall || call->kind == PyAsyncCall::FunctionCall) {
+				PyObject *pValue = NULL;
+				if (pFunc) {
+					PyObject *pArgs = pyValueToPyObject(call->hasArgs ? &call->args : NULL,true);
+					pValue = PyObject_CallObject(pFunc, pArgs);
+					Py_XDECREF(pArgs);
+					Py_DECREF(pFunc);
+				}
+				if (pValue != NULL) {
+					future->m_value.setValue_FromPyObject(pValue,m_lazyConversion);
+					future->m_ok = true;
+					Py_DECREF(pValue);
+				}
+				else if (PyErr_Occurred()) {
+					reportError(doingwhat.str());
+				}
+			}
+			if (!future->m_ok)
+				future->m_error = *lastError();
+		}
+		future->complete();
+	}
+
+	/** \brief Resolve a python function once for repeated calls
+Looks up the function like CallFunction() and returns a PyFunctionHandle holding a
+reference to it. Calling the handle goes straight to the function, which makes it the
+preferred way of calling the same function many times.
+
+  @param Module Module containing function
+  @param Function Function to be resolved
+
+Returns NULL if the module can't be imported or the function isn't callable.
+*/
+	PyFunctionHandle *PySession::resolveFunction(const std::string &moduleName, const std::string &functionName) {
+		PyGILLock lock;
+		PyObject *pFunc = lookupFunction(moduleName,functionName);
+		if (pFunc) {
+			PyFunctionHandle *handle = new PyFunctionHandle(pFunc,this,moduleName,functionName);
+			m_functions.push_back(handle);
+			return handle;
+		}
+		return NULL;
+	}
+
+	PyObject* PySession::lookupFunction(const std::string &moduleName, const std::string &functionName) {
+		PyObject *pModule, *pDict, *pFunc;
+
+		pModule = module(moduleName);
+
+		if (pModule) {
+			pDict = PyModule_GetDict(pModule);
+			pFunc = PyDict_GetItemString(pDict,(char *) functionName.c_str());
+			/* pDict and pFunc are borrowed and must not be Py_DECREF-ed */
+			if (pFunc && PyCallable_Check(pFunc)) {
+				return pFunc;
+			}
+			//      PyErr_Print();
+			std::cerr << "Cannot find function \"" << functionName << "\"" << std::endl;
+		}
+		return NULL;
+	}
+
+	/** \brief PyValue to PyObject conversion
+Converts a PyValue instance to a PyObject. Setting forceTuple to true
+will force the any PyValue into a tuple PyObject. This is usefull for
+calling pythonfunctions since they only accept tupleobjects
+
+  @param inValue PyValue to be converted
+  @param forceTuple Force singlevalues into a single element tuple
+
+Tuples which were converted lazily from python and not modified since are returned as the original
+python tuple, see PyValue. Dicts are always built anew.
+
+The calling thread must hold the GIL, see PyGILLock.
+
+*/
+	PyObject *PySession::pyValueToPyObject(const PyValue *inValue,bool forceTuple) {
+		PyObject *pTuple,*pValue;
+		pTuple = pValue = NULL;
+		if (!inValue) {
+			if (forceTuple) {
+				pTuple = PyTuple_New(0);
+				return pTuple;
+			}
+			else {
+				return NULL;
+			}
+		}
+		if (inValue->valueType()==PyValue::PyTupleType) {
+			const PyTuple &tuple = inValue->valueAsTuple();
+			if (tuple.m_object) {
+				Py_INCREF(tuple.m_object);
+				return tuple.m_object;
+			}
+			pTuple = PyTuple_New(tuple.size());
+
+			for (int i=0;i<tuple.size();i++) {
+				PyTuple_SetItem(pTuple,i,pyValueToPyObject(&tuple.value(i)));
+			}
+			return pTuple;
+		}
+		if (inValue->valueType()==PyValue::PyDictType) {
+			// Python may change a dict after it was converted, so it is never passed on
+			const PyDict &dict = inValue->valueAsDict();
+			pValue = PyDict_New();
+			PyDict::const_iterator it_val = dict.begin();
+			for (; it_val != dict.end(); ++it_val) {
+				PyObject *pKey = pyValueToPyObject(&it_val->key);
+				PyObject *pItem = pyValueToPyObject(&it_val->value);
+				PyDict_SetItem(pValue,pKey,pItem);
+				Py_XDECREF(pKey);
+				Py_XDECREF(pItem);
+			}
+		}
+		else if (inValue->valueType()==PyValue::PyNullType) {
+			Py_INCREF(Py_None);
+			pValue = Py_None;
+		}
+		else if (inValue->valueType()==PyValue::PyLongType) {
+			long longval;
+			longval = inValue->valueAsLong();
+			pValue = PyLong_FromLong(longval);
+		}
+		else if (inValue->valueType()==PyValue::PyDoubleType) {
+			double doubval;
+			doubval = inValue->valueAsDouble();
+			pValue = PyFloat_FromDouble(doubval);
+		}
+		else if (inValue->valueType()==PyValue::PyStringType)	{
+			pValue = PyString_FromStringAndSize(inValue->stringData(),inValue->stringSize());
+		}
+		else if (inValue->valueType()==PyValue::PyUnicodeType)	{
+			pValue = pyUnicodeFromUtf8(inValue->stringData(),inValue->stringSize());
+		}
+		if (forceTuple)	{
+			pTuple = PyTuple_New(1);
+			PyTuple_SetItem(pTuple,0,pValue);
+			return pTuple;
+		}
+		return pValue;
+	}
+
+
+	/** \brief PyValue to PyRef conversion, fx. to pass a PyValue to callFunctionRef() along with
+other PyRef's. Converts like pyValueToPyObject().
+*/
+	PyRef PySession::pyValueToPyRef(const PyValue *value) {
+		PyGILLock lock;
+		return PyRef::steal(pyValueToPyObject(value));
+	}
+
+	/** \brief Build a PyValue object
+
+  @param Format  's' (string) [char *] 
+  's#' (string) [char *, int] <br>
+ *'z' (string or None) [char *] <br>
+ *'z#' (string or None) [char *, int] <br>
+ *'i' (integer) [int] 
+ *'b' (integer) [char] 
+ *'h' (integer) [short int] <br>
+ *'l' (integer) [long int] <br>
+ *'c' (string of length 1) [char] <br>
+ *'d' (float) [double] <br>
+ *'f' (float) [float] <br><br>
+ *'(items)' (tuple) [matching-items] <br>
+ *'[items]' (list) [matching-items] <br>
+
+ *It recognizes a set of format units similar to the ones recognized by PyArg_ParseTuple(),
+ *but the arguments (which are input to the function, not output) must not be pointers, just 
+ *values. It returns a new Python object, suitable for returning from a C function called from Python. 
+ *<br>
+ *One difference with PyArg_ParseTuple(): while the latter requires its first argument to be a 
+ *tuple (since Python argument lists are always represented as tuples internally), BuildValue() 
+ *does not always build a tuple. It builds a tuple only if its format string contains two or more 
+ *format units. If the format string is empty, it returns None; if it contains exactly one format unit, 
+ *it returns whatever object is described by that format unit. To force it to return a tuple of size 0 
+ *or one, parenthesize the format string. <br>
+ *Examples (to the left the call, to the right the resulting Python value): 
+ * <br>
+ *examples:<br>
+ *    buildPyValue("")                        None <br>
+ *    buildPyValue("i", 123)                  123  <br>
+ *    buildPyValue("iii", 123, 456, 789)      (123, 456, 789)<br>
+ *    buildPyValue("s", "hello")              'hello'<br>
+ *    buildPyValue("ss", "hello", "world")    ('hello', 'world')<br>
+ *    buildPyValue("s#", "hello", 4)          'hell'<br>
+ *    buildPyValue("()")                      ()<br>
+ *    buildPyValue("(i)", 123)                (123,)<br>
+ *    buildPyValue("(ii)", 123, 456)          (123, 456)<br>
+ *    buildPyValue("(i,i)", 123, 456)         (123, 456)<br>
+ *    buildPyValue("[i,i]", 123, 456)         [123, 456]<br>
+ *    buildPyValue("{s:i,s:i}",<br>
+ *                  "abc", 123, "def", 456)    {'abc': 123, 'def': 456}<br>
+ *    buildPyValue("((ii)(ii)) (ii)",<br>
+ *                  1, 2, 3, 4, 5, 6)          (((1, 2), (3, 4)), (5, 6))<br>
+ *<br>
+ *pyTuple() and pyDict() build the same values from the types of their arguments, checked at compile
+ *time and without converting through python, see PyValueSetter.
+ */
+
+	PyValue *PySession::buildPyValue(const std::string &format,...) {
+		PyGILLock lock;
+		PyValue *retpyval = NULL;
+		PyObject *val;
+		va_list args;
+		va_start(args,format);
+		val = Py_VaBuildValue((char*)format.c_str(), args);
+		if (val) {
+			retpyval = storeResult(val);
+			Py_DECREF(val);
+		}
+		va_end(args);
+		return retpyval;
+	}
+
+	/** \example buildpyvalue_ex.cpp
+ * This example shows how to use BuildPyValue() to create a new PyValue instance.
+ * In the example 3 values are build a number, a string and a tuple.
+ * Note that m_pySession is a classmember of PySession type.
+ */
+	/** \example pyclass_ex.cpp
+ * This example creates an instance of a simple HTTP reader and retrieves the source
+ * google's mainpage
+ */
+	/** \example callfunction_ex.cpp
+ * The example shows how to call a free python function. In this case the function
+ * "getcwd()" (get current working directory) from the module "os". "os" is one of the
+ * native python modules - see module index on python.org for more information.
+ */
+	/** \example pyerror_ex.cpp
+ * This example demonstrates how to work with python exceptions through the TRPyEmb
+ * framework. The PySession is created with autoalert disabled and thereby leaving
+ * error notification in in the API users hand.
+ */
+	/** \example pypath_ex.cpp
+ * This example demonstrates how to alter python sys.path
+ */
+	/** \example async_ex.cpp
+ * This example calls a slow function asynchronously and picks up the result through the PyFuture.
+ */
+	/** \example interpreterpool_ex.cpp
+ * This example measures how the throughput of calls spending their time in I/O scales with the
+ * number of interpreters in a PyInterpreterPool.
+ */
+	/** \example functionhandle_ex.cpp
+ * This example resolves a function once through resolveFunction() and compares the time spent
+ * calling it through the PyFunctionHandle with calling it by name through CallFunction().
+ */
+	/** \example processpool_ex.cpp
+ * This example compares throughput and 99th percentile latency of CPU bound calls on a
+ * PyInterpreterPool, where the interpreters share the GIL, and on a PyProcessPool.
+ */
+	/** \example resultscope_ex.cpp
+ * This example serves requests in a loop, freeing the results of every request through a PyResultScope.
+ */
+	/** \example tuple_ex.cpp
+ * This example times indexed and iterator loops over a tuple of a million integers and builds a
+ * tuple in place.
+ */
+	/** \example dict_ex.cpp
+ * This example times string key lookups in a dict of 200000 entries and looks up a PyKey.
+ */
+	/** \example lazy_ex.cpp
+ * This example reads one record of a large result with eager and with lazy conversion.
+ */
+	/** \example pyref_ex.cpp
+ * This example chains calls through PyRef's, converting only the final result.
+ */
+	/** \example typedcall_ex.cpp
+ * This example compares typed calls with callFunction() and buildPyValue(), and passes a std::vector.
+ */
+	/** \example buildtuple_ex.cpp
+ * This example compares pyTuple() with buildPyValue(), and builds nested tuples and dicts.
+ */
+	/** \example unicode_ex.cpp
+ * This example passes a large unicode string to python and back, and reads non-ASCII text as UTF-8.
+ */
+	/** \example stringview_ex.cpp
+ * This example reads a downloaded page through a PyStringView without copying it.
+ */
+	/** \example iterator_ex.cpp
+ * This example reads a million rows from a generator with a PyIterator and compares it with callFunction().
+ */
+	/** \example source_ex.cpp
+ * This example passes a std::vector and a generator function to python as iterators.
+ */
+	/** \example hostmodule_ex.cpp
+ * This example lets a script call back into C++ functions through a PyHostModule.
+ */
+}
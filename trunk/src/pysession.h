@@ -1,70 +1,286 @@
-#ifndef PYSESSION_H
-#define PYSESSION_H
-
-#include "pyembdef.h"
-#include "pyerror.h"
-#include "pyvalue.h"
-#include <vector>
-#include <string>
-
-#pragma warning( disable: 4251 )
-
-struct _object;
-typedef _object PyObject;
-
-namespace PyEmb {
-	class PyClass;
-	extern char *pyTraceback_AsString(PyObject *exc_tb);
-
-	typedef std::vector<PyObject*> PyObjectArray;
-	typedef std::vector<PyClass*> PyClassArray;
-
-	/** \class PySession
- PySession is the top of the framework this is where you import module,
- call functions, instantiate class objects etc. Almost all PySession methods return pointers these
- may not be deleted by the calling instance since PySession implements a simple Garbagecollector.<br>
- <br>
- GARBAGE COLLECTION <br>
- Methods returning instance pointers should never be deleted from the calling entity. These instances
- are deleted by the PySession instance on destruction. However, if you are working with very large return
- values you can clear the value buffer manually by calling EmptyResultBuffer() and thereby freeing memory
- <br><br>
-*/
-
-	class PYEMB_DECLSPEC PySession
-	{
-		friend class PyClass;
-	public:
-		PySession(bool autoAlert=true);
-		~PySession();
-		void addToPyPath(const std::string &path);
-		bool importModule(const std::string &moduleName);
-		PyClass *newInstance(const std::string &moduleName, const std::string &className,PyValue *args=NULL); // Garbage collection
-		PyValue *callFunction(const std::string &moduleName, const std::string & functionName, PyValue *args=NULL);  // Garbage collection
-		PyValue *callFunctionObj(const std::string &moduleName, const std::string &functionName, PyObject *args=NULL);  // Garbage collection
-		void emptyResultBuffer();
-		PyError *lastError();
-		PyValue *buildPyValue(const std::string &format,...);  // Garbage collection
-		bool autoAlertEnabled();
-		void setAutoAlertEnabled(bool autoalert);
-		void raiseErrorMessage();
-		void showPath();
-		PyObject *pyValueToPyObject(PyValue *value, bool forceTuple=false); // Must be DECREF'ed to prevent Memoryleaking
-
-	private:
-		void storeError(PyError *error);
-		PyObject *loadModule(const std::string &moduleName);
-		PyObject *createInstance(const std::string &moduleName,const std::string &className,PyObject *args);
-		PyObject *loadedModule(const std::string &moduleName);
-		void loadSysMods();
-
-		PyObjectArray m_modules;
-		PyClassArray m_instances;
-		PyValueArray m_values;
-		bool m_sysModsLoaded;
-		PyError m_lastError;
-		bool m_autoAlert;
-	};
-}
-
-#endif
+#ifndef PYSESSION_H
+#define PYSESSION_H
+
+#include "pyembdef.h"
+#include "pyerror.h"
+#include "pyvalue.h"
+#include "pyfuture.h"
+#include "pyref.h"
+#include "pyiterator.h"
+#include "pyconverter.h"
+#include "pybuildvalue.h"
+#include "pysource.h"
+#include "pyhostmodule.h"
+#include "pygil.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+
+#pragma warning( disable: 4251 )
+
+struct _object;
+typedef _object PyObject;
+struct _ts;
+typedef _ts PyThreadState;
+typedef void *PyThread_type_lock;
+
+namespace PyEmb {
+	class PyClass;
+	class PyFunctionHandle;
+	class PyCallQueue;
+	class PyInterpreterPool;
+	class PyResultScope;
+	struct PyAsyncCall;
+	extern char *pyTraceback_AsString(PyObject *exc_tb);
+
+	typedef std::vector<PyObject*> PyObjectArray;
+	typedef std::map<std::string,PyObject*> PyModuleMap;
+
+	/** \struct PyResult
+ Result of a call returned by value - by PySession::callFunctionResult(), PyClass::callMethodResult(),
+ PyFunctionHandle::callResult() and per call by the batch calls. When ok is false the call raised a
+ python exception, which is described by error.
+ <br><br>
+ The result is not owned by the session. Use swap() to move it into another PyResult, or value.swap()
+ to take the value, without copying the tuples, dicts and strings it holds.
+*/
+	struct PYEMB_DECLSPEC PyResult {
+		PyResult() {ok = false;}
+		void swap(PyResult &other) {value.swap(other.value);std::swap(ok,other.ok);error.swap(other.error);}
+		PyValue value;
+		bool ok;
+		PyError error;
+	};
+
+	typedef PyResult PyBatchResult;
+
+	/** \struct PyAsyncStats
+ Counters of the asynchronous call queue, see PySession::asyncStats().
+ Wait times are the seconds calls spent queued before the interpreter thread picked them up.
+ stolen counts calls taken from other queues of a PyInterpreterPool.
+*/
+	struct PYEMB_DECLSPEC PyAsyncStats {
+		PyAsyncStats() {queued = completed = stolen = 0; depth = maxDepth = 0; totalWait = maxWait = 0.0;}
+		long queued;
+		long completed;
+		long stolen;
+		int depth;
+		int maxDepth;
+		double totalWait;
+		double maxWait;
+	};
+
+	typedef std::vector<PyValue> PyValueList;
+	typedef std::vector<PyBatchResult> PyBatchResultArray;
+	typedef std::vector<PyClass*> PyClassArray;
+	typedef std::vector<PyFunctionHandle*> PyFunctionArray;
+	typedef std::vector<PyFuture*> PyFutureArray;
+	typedef std::vector<PyCallQueue*> PyCallQueueArray;
+
+	/* Result buffer, pending futures and last error of one thread using the session */
+	struct PyThreadData {
+		PyThreadData() {scope = NULL;}
+		PyValueArray values;
+		PyFutureArray futures;
+		PyError lastError;
+		PyResultScope *scope;	// innermost result scope
+	};
+
+	typedef std::vector<PyThreadData*> PyThreadDataArray;
+
+	/** \class PySession
+ PySession is the top of the framework this is where you import module,
+ call functions, instantiate class objects etc. Almost all PySession methods return pointers these
+ may not be deleted by the calling instance since PySession implements a simple Garbagecollector.<br>
+ <br>
+ GARBAGE COLLECTION <br>
+ Methods returning instance pointers should never be deleted from the calling entity. These instances
+ are deleted by the PySession instance on destruction. However, if you are working with very large return
+ values you can clear the value buffer manually by calling EmptyResultBuffer() and thereby freeing memory.
+ Results received while a PyResultScope exists are owned by the scope instead.
+ <br><br>
+ THREADS <br>
+ A PySession may be used from any number of threads. The python global interpreter lock (GIL) is released
+ while the session is idle and acquired for the duration of each call, so only the python execution itself
+ is serialized. Every thread has its own result buffer and its own lastError(). The session must be
+ destroyed by the thread which created it.
+ <br><br>
+ ASYNCHRONOUS CALLS <br>
+ callFunctionAsync() and PyClass::callMethodAsync() queue the call for a dedicated interpreter thread and
+ return a PyFuture immediately. The interpreter thread is started by the first asynchronous call.
+ <br><br>
+*/
+
+	class PYEMB_DECLSPEC PySession
+	{
+		friend class PyClass;
+		friend class PyFunctionHandle;
+		friend class PyMethodHandle;
+		friend class PyCallQueue;
+		friend class PyInterpreterPool;
+		friend class PyProcessPool;
+		friend class PyResultScope;
+		friend class PyIterator;
+	public:
+		PySession(bool autoAlert=true);
+		~PySession();
+		void addToPyPath(const std::string &path);
+		bool importModule(const std::string &moduleName);
+		bool addModule(PyHostModule *module);
+		PyClass *newInstance(const std::string &moduleName, const std::string &className,PyValue *args=NULL); // Garbage collection
+		PyValue *callFunction(const std::string &moduleName, const std::string & functionName, PyValue *args=NULL);  // Garbage collection
+		PyValue *callFunctionObj(const std::string &moduleName, const std::string &functionName, PyObject *args=NULL);  // Garbage collection
+		PyResult callFunctionResult(const std::string &moduleName, const std::string &functionName, PyValue *args=NULL);
+		PyRef callFunctionRef(const std::string &moduleName, const std::string &functionName, PyValue *args=NULL);
+		PyRef callFunctionRef(const std::string &moduleName, const std::string &functionName, const PyRefList &args);
+		PyIterator callFunctionIter(const std::string &moduleName, const std::string &functionName, PyValue *args=NULL);
+		PyBatchResultArray callFunctionBatch(const std::string &moduleName, const std::string &functionName, const PyValueList &args);
+		PyFunctionHandle *resolveFunction(const std::string &moduleName, const std::string &functionName);  // Garbage collection
+		PyFuture *callFunctionAsync(const std::string &moduleName, const std::string &functionName, PyValue *args=NULL,
+			PyFutureCallback callback=NULL, void *userData=NULL);  // Garbage collection
+		PyAsyncStats asyncStats();
+		void emptyResultBuffer();
+		PyError *lastError();
+		PyValue *buildPyValue(const std::string &format,...);  // Garbage collection
+		bool autoAlertEnabled();
+		void setAutoAlertEnabled(bool autoalert);
+		bool lazyConversionEnabled();
+		void setLazyConversionEnabled(bool lazy);
+		void raiseErrorMessage();
+		void showPath();
+		long moduleLookups() const;
+		long moduleLookupHits() const;
+		double moduleHitRate() const;
+		static PyObject *pyValueToPyObject(const PyValue *value, bool forceTuple=false); // Must be DECREF'ed to prevent Memoryleaking
+		PyRef pyValueToPyRef(const PyValue *value);
+
+		/* Typed calls, see PyConverter. fx. session.call<double>("scoring","score",12L,std::string("abc"),3.5)
+		   A python exception or a result which doesn't convert to R is reported through lastError()
+		   and returns R() */
+		template<class R>
+		R call(const std::string &moduleName, const std::string &functionName) {
+			PyGILLock lock;
+			PyObject *pArgs = pyNewTuple(0);
+			return typedResult<R>(typedCall(moduleName,functionName,pArgs),functionName);
+		}
+
+		template<class R, class A1>
+		R call(const std::string &moduleName, const std::string &functionName, const A1 &a1) {
+			PyGILLock lock;
+			PyObject *pArgs = pyNewTuple(1);
+			pySetTupleItem(pArgs,0,PyConverter<A1>::toPython(a1));
+			return typedResult<R>(typedCall(moduleName,functionName,pArgs),functionName);
+		}
+
+		template<class R, class A1, class A2>
+		R call(const std::string &moduleName, const std::string &functionName, const A1 &a1, const A2 &a2) {
+			PyGILLock lock;
+			PyObject *pArgs = pyNewTuple(2);
+			pySetTupleItem(pArgs,0,PyConverter<A1>::toPython(a1));
+			pySetTupleItem(pArgs,1,PyConverter<A2>::toPython(a2));
+			return typedResult<R>(typedCall(moduleName,functionName,pArgs),functionName);
+		}
+
+		template<class R, class A1, class A2, class A3>
+		R call(const std::string &moduleName, const std::string &functionName, const A1 &a1, const A2 &a2, const A3 &a3) {
+			PyGILLock lock;
+			PyObject *pArgs = pyNewTuple(3);
+			pySetTupleItem(pArgs,0,PyConverter<A1>::toPython(a1));
+			pySetTupleItem(pArgs,1,PyConverter<A2>::toPython(a2));
+			pySetTupleItem(pArgs,2,PyConverter<A3>::toPython(a3));
+			return typedResult<R>(typedCall(moduleName,functionName,pArgs),functionName);
+		}
+
+		template<class R, class A1, class A2, class A3, class A4>
+		R call(const std::string &moduleName, const std::string &functionName, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4) {
+			PyGILLock lock;
+			PyObject *pArgs = pyNewTuple(4);
+			pySetTupleItem(pArgs,0,PyConverter<A1>::toPython(a1));
+			pySetTupleItem(pArgs,1,PyConverter<A2>::toPython(a2));
+			pySetTupleItem(pArgs,2,PyConverter<A3>::toPython(a3));
+			pySetTupleItem(pArgs,3,PyConverter<A4>::toPython(a4));
+			return typedResult<R>(typedCall(moduleName,functionName,pArgs),functionName);
+		}
+
+		template<class R, class A1, class A2, class A3, class A4, class A5>
+		R call(const std::string &moduleName, const std::string &functionName, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5) {
+			PyGILLock lock;
+			PyObject *pArgs = pyNewTuple(5);
+			pySetTupleItem(pArgs,0,PyConverter<A1>::toPython(a1));
+			pySetTupleItem(pArgs,1,PyConverter<A2>::toPython(a2));
+			pySetTupleItem(pArgs,2,PyConverter<A3>::toPython(a3));
+			pySetTupleItem(pArgs,3,PyConverter<A4>::toPython(a4));
+			pySetTupleItem(pArgs,4,PyConverter<A5>::toPython(a5));
+			return typedResult<R>(typedCall(moduleName,functionName,pArgs),functionName);
+		}
+
+		template<class R, class A1, class A2, class A3, class A4, class A5, class A6>
+		R call(const std::string &moduleName, const std::string &functionName, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6) {
+			PyGILLock lock;
+			PyObject *pArgs = pyNewTuple(6);
+			pySetTupleItem(pArgs,0,PyConverter<A1>::toPython(a1));
+			pySetTupleItem(pArgs,1,PyConverter<A2>::toPython(a2));
+			pySetTupleItem(pArgs,2,PyConverter<A3>::toPython(a3));
+			pySetTupleItem(pArgs,3,PyConverter<A4>::toPython(a4));
+			pySetTupleItem(pArgs,4,PyConverter<A5>::toPython(a5));
+			pySetTupleItem(pArgs,5,PyConverter<A6>::toPython(a6));
+			return typedResult<R>(typedCall(moduleName,functionName,pArgs),functionName);
+		}
+
+	private:
+		template<class R>
+		R typedResult(PyObject *pValue, const std::string &functionName) {
+			R result = R();
+			if (pValue) {
+				if (!PyConverter<R>::fromPython(pValue,result))
+					reportConversionError(pValue,functionName);
+				pyDecRef(pValue);
+			}
+			return result;
+		}
+
+		PySession(PyInterpreterPool *pool, bool autoAlert);
+		void release();
+		void startInterpreter();
+		void endInterpreter();
+		void storeError(PyError *error);
+		void reportError(const std::string &doingWhat);
+		PyValue *storeResult(PyObject *pValue);
+		void storeFuture(PyFuture *future);
+		PyThreadData *threadData();
+		PyFuture *queueCall(PyAsyncCall *call, PyValue *args, PyFutureCallback callback, void *userData);
+		void runAsyncCall(PyAsyncCall *call);
+		PyObject *loadModule(const std::string &moduleName);
+		PyObject *createInstance(const std::string &moduleName,const std::string &className,PyObject *args);
+		PyObject *loadedModule(const std::string &moduleName);
+		PyObject *module(const std::string &moduleName);
+		PyObject *lookupFunction(const std::string &moduleName, const std::string &functionName);
+		PyBatchResultArray callBatch(PyObject *callable, const PyValueList &args, const std::string &doingWhat);
+		void callResult(PyObject *callable, PyObject *pArgs, const std::string &doingWhat, PyResult &result);
+		PyRef callRef(PyObject *callable, PyObject *pArgs, const std::string &doingWhat);
+		PyObject *refArguments(const PyRefList &args);
+		PyObject *typedCall(const std::string &moduleName, const std::string &functionName, PyObject *pArgs);
+		void reportArgumentError(const std::string &functionName);
+		void reportConversionError(PyObject *pValue, const std::string &functionName);
+		PyObject *argumentTuple(PyObject *pArgs, const PyValue *value);
+		void loadSysMods();
+
+		PyModuleMap m_modules;
+		long m_moduleLookups;
+		long m_moduleLookupHits;
+		PyClassArray m_instances;
+		PyFunctionArray m_functions;
+		PyThreadDataArray m_threads;
+		int m_threadKey;
+		PyThread_type_lock m_threadLock;
+		PyThreadState *m_threadState;
+		PyCallQueue *m_callQueue;
+		PyInterpreterPool *m_pool;
+		bool m_sysModsLoaded;
+		bool m_autoAlert;
+		bool m_lazyConversion;
+	};
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include "pyshmring.h"
+
+#ifndef WIN32
+
+#include <sys/mman.h>
+#include <errno.h>
+#include <time.h>
+#include <cstring>
+
+namespace PyEmb {
+	/* Map a ring with room for at least size bytes of messages. The mapping is shared with
+	   processes forked afterwards. Returns NULL if the memory can't be mapped */
+	PyShmRing *PyShmRing::create(unsigned int size) {
+		// A power of two keeps positions modulo the size valid when the counters wrap
+		unsigned int capacity = 64;
+		while (capacity < size && capacity < 0x80000000u)
+			capacity *= 2;
+		size = capacity;
+		void *memory = mmap(NULL,sizeof(PyShmRing)+size,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+		if (memory == MAP_FAILED)
+			return NULL;
+		PyShmRing *ring = (PyShmRing *) memory;
+		sem_init(&ring->m_messages,1,0);
+		sem_init(&ring->m_space,1,0);
+		ring->m_head = 0;
+		ring->m_tail = 0;
+		ring->m_closed = false;
+		ring->m_size = size;
+		return ring;
+	}
+
+	void PyShmRing::destroy(PyShmRing *ring) {
+		sem_destroy(&ring->m_messages);
+		sem_destroy(&ring->m_space);
+		munmap(ring,sizeof(PyShmRing)+ring->m_size);
+	}
+
+	/* Test whether a message can ever be written */
+	bool PyShmRing::fits(const std::string &message) const {
+		return message.size()+sizeof(unsigned int) <= m_size;
+	}
+
+	/* Append a message, waits while the ring is full. Returns false if the message
+	   doesn't fit or the ring was closed */
+	bool PyShmRing::write(const std::string &message) {
+		if (!fits(message))
+			return false;
+		unsigned int length = message.size();
+		unsigned int needed = length+sizeof(unsigned int);
+		// m_head and m_tail count bytes ever written and read, their difference is the fill
+		while (m_size-(m_head-m_tail) < needed) {
+			if (m_closed)
+				return false;
+			waitFor(&m_space,100);
+		}
+		if (m_closed)
+			return false;
+		copyIn(m_head,(const char *) &length,sizeof(unsigned int));
+		copyIn(m_head+sizeof(unsigned int),message.data(),length);
+		__sync_synchronize();
+		m_head += needed;
+		sem_post(&m_messages);
+		return true;
+	}
+
+	/* Take the next message. Waits up to timeout milliseconds, or forever if timeout
+	   is negative. Returns false if no message arrived */
+	bool PyShmRing::read(std::string &message, int timeout) {
+		if (!waitFor(&m_messages,timeout))
+			return false;
+		unsigned int length;
+		copyOut(m_tail,(char *) &length,sizeof(unsigned int));
+		message.resize(length);
+		if (length)
+			copyOut(m_tail+sizeof(unsigned int),&message[0],length);
+		__sync_synchronize();
+		m_tail += length+sizeof(unsigned int);
+		sem_post(&m_space);
+		return true;
+	}
+
+	/* Make writers give up, used when the reading process is gone */
+	void PyShmRing::close() {
+		m_closed = true;
+		sem_post(&m_space);
+	}
+
+	void PyShmRing::copyIn(unsigned int pos, const char *data, unsigned int length) {
+		unsigned int offset = pos % m_size;
+		unsigned int first = length < m_size-offset ? length : m_size-offset;
+		memcpy(m_data+offset,data,first);
+		memcpy(m_data,data+first,length-first);
+	}
+
+	void PyShmRing::copyOut(unsigned int pos, char *data, unsigned int length) const {
+		unsigned int offset = pos % m_size;
+		unsigned int first = length < m_size-offset ? length : m_size-offset;
+		memcpy(data,m_data+offset,first);
+		memcpy(data+first,m_data,length-first);
+	}
+
+	bool PyShmRing::waitFor(sem_t *sem, int timeout) {
+		if (timeout < 0) {
+			while (sem_wait(sem) < 0) {
+				if (errno != EINTR)
+					return false;
+			}
+			return true;
+		}
+		struct timespec until;
+		clock_gettime(CLOCK_REALTIME,&until);
+		until.tv_sec += timeout/1000;
+		until.tv_nsec += (timeout%1000)*1000000L;
+		if (until.tv_nsec >= 1000000000L) {
+			until.tv_sec++;
+			until.tv_nsec -= 1000000000L;
+		}
+		while (sem_timedwait(sem,&until) < 0) {
+			if (errno != EINTR)
+				return false;
+		}
+		return true;
+	}
+}
+
+#endif
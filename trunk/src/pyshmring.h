@@ -0,0 +1,41 @@
+#ifndef PYSHMRING_H
+#define PYSHMRING_H
+
+#ifndef WIN32
+
+#include <semaphore.h>
+#include <string>
+
+namespace PyEmb {
+	/* Ring buffer of length prefixed messages in memory shared with forked processes.
+	   There may be one writer and one reader at a time, in the same or in different processes.
+	   Messages are copied in and out, a message must fit the ring as a whole */
+	class PyShmRing {
+
+	public:
+		static PyShmRing *create(unsigned int size);
+		static void destroy(PyShmRing *ring);
+		bool write(const std::string &message);
+		bool read(std::string &message, int timeout);
+		void close();
+		bool fits(const std::string &message) const;
+
+	private:
+		PyShmRing();
+		void copyIn(unsigned int pos, const char *data, unsigned int length);
+		void copyOut(unsigned int pos, char *data, unsigned int length) const;
+		bool waitFor(sem_t *sem, int timeout);
+
+		sem_t m_messages;
+		sem_t m_space;
+		volatile unsigned int m_head;
+		volatile unsigned int m_tail;
+		volatile bool m_closed;
+		unsigned int m_size;
+		char m_data[1];
+	};
+}
+
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+#include <Python.h>
+#include "pysource.h"
+#include "pygil.h"
+
+#include <exception>
+
+namespace PyEmb {
+	/* Python object of a source iterator */
+	struct PySourceObject {
+		PyObject_HEAD
+		PySource *source;
+	};
+
+	static void sourceDealloc(PyObject *self) {
+		delete ((PySourceObject *) self)->source;
+		PyObject_Del(self);
+	}
+
+	static PyObject *sourceNext(PyObject *self) {
+		PySourceObject *object = (PySourceObject *) self;
+		if (!object->source)
+			return NULL;
+		PyObject *item = NULL;
+		// Exceptions may not pass through python
+		try {
+			item = object->source->next();
+		}
+		catch (std::exception &e) {
+			PyErr_SetString(PyExc_RuntimeError,e.what());
+		}
+		catch (...) {
+			PyErr_SetString(PyExc_RuntimeError,"C++ exception");
+		}
+		if (!item && !PyErr_Occurred()) {
+			// Exhausted, the source is released as soon as python is done with it
+			delete object->source;
+			object->source = NULL;
+		}
+		return item;
+	}
+
+	static PyTypeObject sourceType = {
+		PyVarObject_HEAD_INIT(NULL,0)
+		"pyemb.iterator",			// tp_name
+		sizeof(PySourceObject),		// tp_basicsize
+		0,							// tp_itemsize
+		sourceDealloc,				// tp_dealloc
+		0,							// tp_print
+		0,							// tp_getattr
+		0,							// tp_setattr
+		0,							// tp_compare
+		0,							// tp_repr
+		0,							// tp_as_number
+		0,							// tp_as_sequence
+		0,							// tp_as_mapping
+		0,							// tp_hash
+		0,							// tp_call
+		0,							// tp_str
+		0,							// tp_getattro
+		0,							// tp_setattro
+		0,							// tp_as_buffer
+		Py_TPFLAGS_DEFAULT,			// tp_flags
+		"Iterator over elements produced in C++",	// tp_doc
+		0,							// tp_traverse
+		0,							// tp_clear
+		0,							// tp_richcompare
+		0,							// tp_weaklistoffset
+		PyObject_SelfIter,			// tp_iter
+		sourceNext,					// tp_iternext
+		0,							// tp_methods
+		0,							// tp_members
+		0,							// tp_getset
+		0,							// tp_base
+		0,							// tp_dict
+		0,							// tp_descr_get
+		0,							// tp_descr_set
+		0,							// tp_dictoffset
+		0,							// tp_init
+		0,							// tp_alloc
+		0,							// tp_new
+		0,							// tp_free
+		0,							// tp_is_gc
+		0,							// tp_bases
+		0,							// tp_mro
+		0,							// tp_cache
+		0,							// tp_subclasses
+		0,							// tp_weaklist
+		0,							// tp_del
+		0							// tp_version_tag
+	};
+
+	/* The type is readied on first use, with the GIL held */
+	static bool sourceTypeReady() {
+		if (sourceType.tp_flags & Py_TPFLAGS_READY)
+			return true;
+		return PyType_Ready(&sourceType) == 0;
+	}
+
+	/** \brief Python iterator of source. The source is deleted with the iterator, or when it is
+	    exhausted. Returns a null PyRef if the iterator can not be created */
+	PyRef pySourceIterator(PySource *source) {
+		PyGILLock lock;
+		PySourceObject *object = NULL;
+		if (sourceTypeReady())
+			object = PyObject_New(PySourceObject,&sourceType);
+		if (!object) {
+			PyErr_Clear();
+			delete source;
+			return PyRef();
+		}
+		object->source = source;
+		PyRef ref((PyObject *) object);
+		Py_DECREF(object);
+		return ref;
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef PYSOURCE_H
+#define PYSOURCE_H
+
+#include "pyembdef.h"
+#include "pyref.h"
+#include "pyconverter.h"
+#include <iterator>
+
+namespace PyEmb {
+	/** \class PySource
+ A PySource produces the elements of a python iterator implemented in C++, see pyIterate() and
+ pyGenerate(). Python pulls the elements one at a time, and each is converted when it is pulled, so a
+ large input is passed to python without building a PyTuple or a python list of it.
+ <br><br>
+ Derive from PySource to produce elements some other way. The source is deleted with the python iterator.
+*/
+	class PYEMB_DECLSPEC PySource {
+
+	public:
+		virtual ~PySource() {}
+		/* The next element as a new reference, or NULL at the end. Called with the GIL held, a python
+		   exception set along with NULL is raised in python */
+		virtual PyObject *next() = 0;
+	};
+
+	/** \brief The elements of [begin,end), converted by PyConverter */
+	template<class Iterator> class PyRangeSource : public PySource {
+
+	public:
+		PyRangeSource(Iterator begin, Iterator end) : m_pos(begin), m_end(end) {}
+		PyObject *next() {
+			if (m_pos == m_end)
+				return NULL;
+			PyObject *item = PyConverter<typename std::iterator_traits<Iterator>::value_type>::toPython(*m_pos);
+			++m_pos;
+			return item;
+		}
+
+	private:
+		Iterator m_pos;
+		Iterator m_end;
+	};
+
+	/** \brief Called for every element of a pyGenerate() iterator, sets value and returns true, or returns
+	    false at the end */
+	template<class T> struct PyGenerator {
+		typedef bool (*Function)(T &value, void *userData);
+	};
+
+	/** \brief The values of a generator function, converted by PyConverter */
+	template<class T> class PyGeneratorSource : public PySource {
+
+	public:
+		PyGeneratorSource(typename PyGenerator<T>::Function generator, void *userData) :
+			m_generator(generator), m_userData(userData) {}
+		PyObject *next() {
+			T value;
+			if (!m_generator(value,m_userData))
+				return NULL;
+			return PyConverter<T>::toPython(value);
+		}
+
+	private:
+		typename PyGenerator<T>::Function m_generator;
+		void *m_userData;
+	};
+
+	/* Python iterator of source, which it takes over */
+	PYEMB_DECLSPEC PyRef pySourceIterator(PySource *source);
+
+	/** \brief Python iterator of the elements of [begin,end), fx. to pass a std::vector or a file to a
+	    function which iterates it:
+	    session.call<double>("stats","mean",pyIterate(values.begin(),values.end()))
+	    The range must stay valid while python iterates it, which is normally during the call */
+	template<class Iterator> PyRef pyIterate(Iterator begin, Iterator end) {
+		return pySourceIterator(new PyRangeSource<Iterator>(begin,end));
+	}
+
+	/** \brief Python iterator of the values of generator, called with userData until it returns false */
+	template<class T> PyRef pyGenerate(bool (*generator)(T &value, void *userData), void *userData=NULL) {
+		return pySourceIterator(new PyGeneratorSource<T>(generator,userData));
+	}
+}
+
+#endif
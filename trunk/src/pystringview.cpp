@@ -0,0 +1,43 @@
+#include <Python.h>
+#include "pystringview.h"
+#include "pygil.h"
+
+#include <algorithm>
+
+namespace PyEmb {
+	PyStringView::PyStringView() {
+		m_data = "";
+		m_size = 0;
+	}
+
+	/** \brief View the bytes of the object of ref, or a null view if it has no read buffer */
+	PyStringView::PyStringView(const PyRef &ref) {
+		m_data = "";
+		m_size = 0;
+		PyObject *object = ref.object();
+		if (!object) {
+			return;
+		}
+		PyGILLock lock;
+		const char *data;
+		Py_ssize_t size;
+		if (PyString_Check(object)) {
+			data = PyString_AS_STRING(object);
+			size = PyString_GET_SIZE(object);
+		}
+		else if (PyUnicode_Check(object) || PyObject_AsReadBuffer(object,(const void **) &data,&size) != 0) {
+			// The buffer of a unicode string is its internal characters, not text
+			PyErr_Clear();
+			return;
+		}
+		m_ref = ref;
+		m_data = data;
+		m_size = size;
+	}
+
+	void PyStringView::swap(PyStringView &other) {
+		m_ref.swap(other.m_ref);
+		std::swap(m_data,other.m_data);
+		std::swap(m_size,other.m_size);
+	}
+}
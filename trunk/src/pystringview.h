@@ -0,0 +1,47 @@
+#ifndef PYSTRINGVIEW_H
+#define PYSTRINGVIEW_H
+
+#include "pyembdef.h"
+#include "pyref.h"
+#include <string>
+
+#pragma warning( disable: 4251 )
+
+namespace PyEmb {
+	/** \class PyStringView
+ A PyStringView reads the bytes of a python string, or of another object with a read buffer such as a
+ bytearray, where python stores them. Nothing is copied: the view holds a reference to the object, so
+ the data stays valid as long as the view, and the size is the object's, so embedded NUL's are kept.
+ Get one from PySession::callFunctionRef() or PyClass::callMethodRef(), or from a typed call,
+ call<PyStringView>(). Passed back to python, the view is the object it was made from.
+ <br><br>
+ Objects without a read buffer, and unicode strings, give a null view. A string is immutable, but the view
+ of a mutable buffer is invalid once python resizes the buffer. Like a PyRef, copying and releasing a view
+ acquires the GIL, and it must be released before the PySession is destroyed.
+*/
+	class PYEMB_DECLSPEC PyStringView {
+
+	public:
+		typedef const char *const_iterator;
+
+		PyStringView();
+		PyStringView(const PyRef &ref);
+		void swap(PyStringView &other);
+		bool isNull() const {return m_ref.isNull();}
+		const PyRef &ref() const {return m_ref;}
+		const char *data() const {return m_data;}
+		size_t size() const {return m_size;}
+		bool empty() const {return m_size == 0;}
+		const_iterator begin() const {return m_data;}
+		const_iterator end() const {return m_data+m_size;}
+		char operator[](size_t index) const {return m_data[index];}
+		std::string str() const {return std::string(m_data,m_size);}
+
+	private:
+		PyRef m_ref;
+		const char *m_data;
+		size_t m_size;
+	};
+}
+
+#endif
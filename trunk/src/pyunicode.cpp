@@ -0,0 +1,69 @@
+#include <Python.h>
+#include "pyunicode.h"
+
+#include <cstring>
+
+namespace PyEmb {
+	/* Unsigned type of the characters of unicode objects */
+#if Py_UNICODE_SIZE == 4
+	typedef Py_UCS4 UnicodeChar;
+#else
+	typedef unsigned short UnicodeChar;
+#endif
+
+	/* Characters are copied in blocks of this size, the block is then tested */
+	static const size_t blockSize = 256;
+
+	/* Copy characters while none has a bit of ~0x7f set, returns false at a non-ASCII block.
+	   A block is copied while or'ing its characters together, in one plain loop which compilers
+	   vectorize, so ASCII text is tested and copied at the speed of memcpy. From is unsigned */
+	template <class From, class To> static bool copyAscii(const From *data, size_t size, To *out) {
+		const From nonAscii = (From) ~(From) 0x7f;
+		size_t i = 0;
+		for (; i+blockSize <= size; i += blockSize) {
+			// A local copy, so the compiler knows out does not overlap the characters
+			From chars[blockSize];
+			memcpy(chars,data+i,sizeof(chars));
+			From bits = 0;
+			for (size_t j=0;j<blockSize;j++) {
+				bits |= chars[j];
+				out[i+j] = (To) chars[j];
+			}
+			if (bits & nonAscii)
+				return false;
+		}
+		for (; i<size; i++) {
+			if (data[i] & nonAscii)
+				return false;
+			out[i] = (To) data[i];
+		}
+		return true;
+	}
+
+	bool pyUnicodeCopyAscii(PyObject *unicode, char *out) {
+		return copyAscii((const UnicodeChar *) PyUnicode_AS_UNICODE(unicode),PyUnicode_GET_SIZE(unicode),out);
+	}
+
+	bool pyUnicodeToUtf8(PyObject *unicode, std::string &value) {
+		value.resize(PyUnicode_GET_SIZE(unicode));
+		if (value.empty() || pyUnicodeCopyAscii(unicode,&value[0]))
+			return true;
+		PyObject *pUtf8 = PyUnicode_AsUTF8String(unicode);
+		if (!pUtf8) {
+			PyErr_Clear();
+			return false;
+		}
+		value.assign(PyString_AS_STRING(pUtf8),PyString_GET_SIZE(pUtf8));
+		Py_DECREF(pUtf8);
+		return true;
+	}
+
+	PyObject *pyUnicodeFromUtf8(const char *data, size_t size) {
+		PyObject *unicode = PyUnicode_FromUnicode(NULL,size);
+		if (unicode && !copyAscii((const unsigned char *) data,size,(UnicodeChar *) PyUnicode_AS_UNICODE(unicode))) {
+			Py_DECREF(unicode);
+			unicode = PyUnicode_DecodeUTF8(data,size,"replace");
+		}
+		return unicode;
+	}
+}
@@ -0,0 +1,25 @@
+#ifndef PYUNICODE_H
+#define PYUNICODE_H
+
+#include <string>
+
+struct _object;
+typedef _object PyObject;
+
+namespace PyEmb {
+	/* UTF-8 conversion of python unicode strings. ASCII text, by far the most common, is scanned
+	   a machine word at a time and copied directly, without an intermediate python string.
+	   Call with the GIL held */
+
+	/* Copy the characters of a unicode object, PyUnicode_GET_SIZE() bytes, if they are all ASCII.
+	   Returns false if there are other characters, out is then partly written */
+	bool pyUnicodeCopyAscii(PyObject *unicode, char *out);
+
+	/* UTF-8 text of a unicode object. Returns false if it can not be encoded */
+	bool pyUnicodeToUtf8(PyObject *unicode, std::string &value);
+
+	/* New unicode object from UTF-8 text. Invalid sequences are replaced by U+FFFD */
+	PyObject *pyUnicodeFromUtf8(const char *data, size_t size);
+}
+
+#endif
@@ -1,490 +1,1138 @@
-#include "pyvalue.h"
-#include "cdebug.h"
-
-#include <Python.h>
-#include <sstream>
-#include <iostream>
-
-namespace PyEmb {
-
-	PyValue pyNullValue = PyValue();
-
-	PyValue::PyValue(PyObject *pValue) {
-
-		CDEBUG << "PvValue create: " << this << std::endl;
-		m_valueType = PyNullType;
-		m_tuple = NULL;
-		m_dict = NULL;
-		setValue_FromPyObject(pValue);
-	}
-
-	PyValue::PyValue(const PyValue &value) {
-		CDEBUG << "PvValue create: " << this << std::endl;
-		m_tuple = NULL;
-		m_dict= NULL;
-		deepCopy(value);
-	}
-
-	PyValue::PyValue() {
-		CDEBUG << "PvValue create: " << this << std::endl;
-		m_valueType = PyNullType;
-		m_tuple = NULL;
-		m_dict = NULL;
-	}
-
-
-	PyValue::~PyValue() {
-		CDEBUG << "PvValue delete: " << this << std::endl;
-		valueRelease();
-	}
-
-	void PyValue::deepCopy(const PyValue &value) {
-		valueRelease();
-		m_valueType = value.valueType();
-		if (value.valueType() == PyLongType) {
-			setValueAsLong(value.valueAsLong());
-		}
-		if (value.valueType() == PyDoubleType) {
-			setValueAsDouble(value.valueAsDouble());
-		}
-		if (value.valueType() == PyStringType) {
-			setValueAsString(value.valueAsString());
-		}
-		if (value.valueType() == PyTupleType) {
-			setValueAsTuple(value.valueAsTuple());
-		}
-		if (value.valueType() == PyDictType) {
-			setValueAsDict(value.valueAsDict());
-		}
-	}
-
-	long PyValue::valueAsLong(bool *ok) const {
-		bool success = false;
-		if (m_valueType == PyLongType) {
-			success = true;
-		}
-		if (ok) {
-			*ok = success;
-		}
-		return m_longVal;
-	}
-
-	double PyValue::valueAsDouble(bool *ok) const {
-		bool success = false;
-		if (m_valueType == PyDoubleType) {
-			success = true;
-		}
-		if (ok) {
-			*ok = success;
-		}
-		return m_doubleVal;
-	}
-
-	const std::string &PyValue::valueAsString(bool *ok) const {
-		bool success = false;
-		if (m_valueType == PyStringType) {
-			success = true;
-		}
-		if (ok) {
-			*ok = success;
-		}
-		return m_stringVal;
-	}
-
-	const PyTuple &PyValue::valueAsTuple(bool *ok) const {
-		bool success = false;
-		if (m_valueType == PyTupleType) {
-			success = true;
-		}
-		if (ok) {
-			*ok = success;
-		}
-		return *m_tuple;
-	}
-
-	const PyDict &PyValue::valueAsDict(bool *ok) const {
-		bool success = false;
-		if (m_valueType == PyDictType) {
-			success = true;
-		}
-		if (ok) {
-			*ok = success;
-		}
-		return *m_dict;
-	}
-
-	void PyValue::setValueAsLong(long value) {
-		valueRelease();
-		m_valueType = PyLongType;
-		m_longVal = value;
-	}
-
-	void PyValue::setValueAsDouble(double value) {
-		valueRelease();
-		m_valueType = PyDoubleType;
-		m_doubleVal = value;
-	}
-
-	void PyValue::setValueAsString(const std::string &value) {
-		valueRelease();
-		m_valueType = PyStringType;
-		m_stringVal = value;
-	}
-
-	void PyValue::setValueAsTuple(const PyTuple &value) {
-		valueRelease();
-		m_valueType = PyTupleType;
-		m_tuple = new PyTuple(value);
-	}
-
-	void PyValue::setValueAsDict(const PyDict &value) {
-		valueRelease();
-		m_valueType = PyDictType;
-		m_dict = new PyDict(value);
-	}
-
-	void PyValue::setValue_FromPyObject(PyObject *pValue) {
-		bool decRefList = false;
-		valueRelease();
-		if (pValue) {
-			if (PyList_Check(pValue)) {
-				decRefList = true;
-				pValue = PyList_AsTuple(pValue);
-			}
-			else if (PyUnicode_Check(pValue)) {
-				m_valueType = PyUnicodeType;
-			}
-			else if (PyFloat_Check(pValue)) {
-				m_doubleVal = PyFloat_AsDouble(pValue);
-				m_valueType = PyDoubleType;
-			}
-			else if (PyInt_Check(pValue)) {
-				m_longVal = PyInt_AsLong(pValue);
-				m_valueType = PyLongType;
-			}
-			else if (PyLong_Check(pValue)) {
-				m_longVal = PyLong_AsLong(pValue);
-				m_valueType = PyLongType;
-			}
-			else if (PyString_Check(pValue)) {
-				setValueAsString(PyString_AsString(pValue));
-				m_valueType = PyStringType;
-			}
-			else if (PyTuple_Check(pValue)) {
-				m_tuple = new PyTuple(pValue);
-				m_valueType = PyTupleType;
-			}
-			else if (PyDict_Check(pValue)) {
-				m_dict = new PyDict(pValue);
-				m_valueType = PyDictType;
-			}
-
-			if (decRefList) {
-				Py_XDECREF(pValue);
-			}
-		}
-	}
-
-	void PyValue::valueRelease() {
-		m_valueType = PyNullType;
-		if (m_tuple) {
-			delete m_tuple;
-			m_tuple = NULL;
-		}
-		if (m_dict) {
-			delete m_dict;
-			m_dict = NULL;
-		}
-	}
-
-	std::string &replaceInStdString(std::string &s, const std::string &sub,const std::string &other) {
-		assert(!sub.empty());
-		size_t b = 0;
-		for (;;) {
-			b = s.find(sub, b);
-			if (b == s.npos) break;
-			s.replace(b, sub.size(), other);
-			b += other.size();
-		}
-		return s;
-	}
-
-	PyValue &PyValue::operator=(const PyValue &other) {
-		CDEBUG << "PvValue operator=: " << this << std::endl;
-		deepCopy(other);
-		return *this;
-	}
-
-	bool PyValue::operator<(const PyValue &other) const {
-		if (valueType()<other.valueType()) {
-			return true;
-		}
-		else if (valueType()==PyLongType && m_longVal<other.valueAsLong()) {
-			return true;
-		}
-		else if (valueType()==PyDoubleType && m_doubleVal<other.valueAsDouble()) {
-			return true;
-		}
-		else if (valueType()==PyStringType && m_stringVal<other.valueAsString()) {
-			return true;
-		}
-		return false;
-	}
-
-	std::string PyValue::str() const {
-		CDEBUG << "printing: " << this << std::endl;
-		std::ostringstream strstream;
-		if (valueType() == PyLongType) {
-			strstream << m_longVal;
-		}
-		if (valueType() == PyDoubleType) {
-			strstream << m_doubleVal;
-		}
-		if (valueType() == PyStringType) {
-			std::string tmp = m_stringVal;
-			replaceInStdString(tmp,"\n","\\n");
-			strstream << "'" << tmp << "'";
-		}
-		if (valueType() == PyTupleType) {
-			strstream << m_tuple->str();
-		}
-		if (valueType() == PyDictType) {
-			strstream << m_dict->str();
-		}
-		if (valueType() == PyNullType) {
-			strstream << "None";
-		}
-		return strstream.str();
-
-	}
-
-
-	/////////////////////////////
-	//  PyTuple
-	/////////////////////////////
-
-
-	PyTuple::PyTuple() {
-		CDEBUG << "PvTuple create: " << this << std::endl;
-	}
-
-	PyTuple::PyTuple(PyObject *pTuple) {
-		CDEBUG << "PvTuple create: " << this << std::endl;
-		if (!PyTuple_Check(pTuple)) {
-			return;
-		}
-		for (int i=0;i<PyTuple_Size(pTuple);i++) {
-			PyValue *newVal = new PyValue(PyTuple_GetItem(pTuple,i));
-			m_valueArray.push_back(newVal);
-		}
-	}
-
-
-	PyTuple::PyTuple(const PyTuple &tuple) {
-		CDEBUG << "PyTuple create: " << this << std::endl;
-		deepCopy(tuple);
-	}
-
-	PyTuple &PyTuple::operator=(const PyTuple &other) {
-		CDEBUG << "PyTuple operator=: " << this << std::endl;
-		deepCopy(other);
-		return *this;
-	}
-
-	bool PyTuple::operator<(const PyTuple &other) const {
-		if (size() < other.size()) {
-			return true;
-		}
-		else if (size() > other.size()) {
-			return false;
-		}
-		PyValueArray::const_iterator it_val = m_valueArray.begin();
-		PyValueArray::const_iterator it_val_other = other.m_valueArray.begin();
-		for (; it_val!=m_valueArray.end(); ++it_val,++it_val_other) {
-			if (*(*it_val) < *(*it_val_other)) {
-				return true;
-			}
-		}
-		return false;
-	}
-
-	void PyTuple::deepCopy(const PyTuple &tuple) {
-		PyValueArray::const_iterator it_val = tuple.m_valueArray.begin();
-		for (; it_val!=tuple.m_valueArray.end(); ++it_val) {
-			PyValue *newVal = new PyValue(*(*it_val));
-			m_valueArray.push_back(newVal);
-		}
-	}
-
-	PyTuple::~PyTuple() {
-		CDEBUG << "PvTuple delete: " << this << std::endl;
-		PyValueArray::iterator it_val = m_valueArray.begin();
-		for (; it_val!=m_valueArray.end(); ++it_val) {
-			delete *it_val;
-		}
-	}
-
-	PyValue* PyTuple::value(int index) {
-		if (index >= (int) m_valueArray.size()) {
-			return NULL;
-		}
-		int cnt = 0;
-		PyValueArray::iterator it_val = m_valueArray.begin();
-		for (; it_val!=m_valueArray.end(); ++it_val) {
-			if (cnt==index) {
-				return *it_val;
-			}
-			cnt++;
-		}
-		return NULL;
-	}
-
-	const PyValue &PyTuple::value(int index) const {
-		if (index >= (int) m_valueArray.size()) {
-			return pyNullValue;
-		}
-		int cnt = 0;
-		PyValueArray::const_iterator it_val = m_valueArray.begin();
-		for (; it_val!=m_valueArray.end(); ++it_val) {
-			if (cnt==index) {
-				return *(*it_val);
-			}
-			cnt++;
-		}
-		return pyNullValue;
-	}
-
-	void PyTuple::addValue(const PyValue &val) {
-		m_valueArray.push_back(new PyValue(val));
-	}
-
-	void PyTuple::removeValue(int index) {
-		if (index >= (int) m_valueArray.size()) {
-			return;
-		}
-		int cnt = 0;
-		PyValueArray::iterator it_val = m_valueArray.begin();
-		for (; it_val!=m_valueArray.end(); ++it_val) {
-			if (cnt==index) {
-				delete *it_val;
-				m_valueArray.erase(it_val);
-			}
-			cnt++;
-		}
-	}
-
-	std::string PyTuple::str() const {
-		std::ostringstream strstream;
-		strstream << '(';
-		bool first = true;
-		PyValueArray::const_iterator it_val = m_valueArray.begin();
-		for (; it_val!=m_valueArray.end(); ++it_val) {
-			if (!first) {
-				strstream << ",";
-			}
-			strstream << (*it_val)->str();
-			first = false;
-		}
-		if (m_valueArray.size()==1) {
-			strstream << ",";
-		}
-		strstream << ')';
-		return strstream.str();
-	}
-
-
-
-	PyDict::PyDict() {
-
-	}
-
-	PyDict::PyDict(PyObject *pDict){
-		CDEBUG << "PyDict create: " << this << std::endl;
-		if (!PyDict_Check(pDict)) {
-			return;
-		}
-		PyObject *items = PyDict_Items(pDict);
-		if (!PyList_Check(items)) {
-			return;
-		}
-
-		for (int i=0;i<PyList_Size(items);i++) {
-			PyObject *item = PyList_GetItem(items,i);
-			if (!PyTuple_Check(item)) {
-				return;
-			}
-			PyValue key(PyTuple_GetItem(item, 0));
-			PyValue *val = new PyValue(PyTuple_GetItem(item, 1));
-			m_valueMap[key] = val;
-		}
-		Py_XDECREF(items);
-	}
-
-	PyDict::PyDict(const PyDict &dict) {
-		deepCopy(dict);
-	}
-
-	PyDict::~PyDict() {
-		PyValueMap::iterator it = m_valueMap.begin();
-		for (; it!=m_valueMap.end(); ++it) {
-			delete it->second;
-		}
-	}
-
-	PyDict &PyDict::operator=(const PyDict &other) {
-		CDEBUG << "PyDict operator=: " << this << std::endl;
-		deepCopy(other);
-		return *this;
-	}
-
-	void PyDict::deepCopy(const PyDict &dict) {
-		PyValueMap::const_iterator it = dict.m_valueMap.begin();
-		for (; it!=dict.m_valueMap.end(); ++it) {
-			m_valueMap[it->first] = new PyValue(*(it->second));
-		}
-	}
-
-	PyValue *PyDict::value(const PyValue &key) {
-		PyValueMap::iterator it = m_valueMap.find(key);
-		if (it!=m_valueMap.end()) {
-			return it->second;
-		}
-		return NULL;
-	}
-
-	const PyValue &PyDict::value(const PyValue &key) const {
-		PyValueMap::const_iterator it = m_valueMap.find(key);
-		if (it!=m_valueMap.end()) {
-			return *(it->second);
-		}
-		return pyNullValue;
-	}
-
-	void PyDict::setValue(const PyValue &key, const PyValue &val) {
-		m_valueMap[key] = new PyValue(val);
-	}
-
-	void PyDict::removeValue(const PyValue &key) {
-		PyValueMap::iterator it = m_valueMap.find(key);
-		if (it!=m_valueMap.end()) {
-			delete it->second;
-			m_valueMap.erase(it);
-		}
-	}
-
-	std::string PyDict::str() const {
-		std::ostringstream strstream;
-		strstream << '{';
-		bool first = true;
-		PyValueMap::const_iterator it_val = m_valueMap.begin();
-		for (; it_val!=m_valueMap.end(); ++it_val) {
-			if (!first) {
-				strstream << ",";
-			}
-			strstream << it_val->first.str() << ":" << it_val->second->str();
-			first = false;
-		}
-		strstream << '}';
-		return strstream.str();
-	}
-}
+#include "pyvalue.h"
+#include "pygil.h"
+#include "pyunicode.h"
+#include "cdebug.h"
+
+#include <Python.h>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+namespace PyEmb {
+
+	PyValue pyNullValue = PyValue();
+
+	/* m_smallSize of a string stored in m_string */
+	static const unsigned char largeString = 0xff;
+
+	/* Reference counts of shared tuples and dicts, which may be copied by any thread */
+	static void retain(volatile long &refs) {
+#ifdef WIN32
+		InterlockedIncrement(&refs);
+#else
+		__sync_add_and_fetch(&refs,1);
+#endif
+	}
+
+	/* True when the last reference is released */
+	static bool release(volatile long &refs) {
+#ifdef WIN32
+		return InterlockedDecrement(&refs) == 0;
+#else
+		return __sync_sub_and_fetch(&refs,1) == 0;
+#endif
+	}
+
+	/* Make the converted contents of a lazy tuple or dict visible to other threads before they
+	   see it is converted */
+	static void publish() {
+#ifdef WIN32
+		MemoryBarrier();
+#else
+		__sync_synchronize();
+#endif
+	}
+
+	/* FNV-1a hash of a number of bytes, continuing from hash */
+	static unsigned int hashBytes(const void *data, size_t size, unsigned int hash) {
+		const unsigned char *bytes = (const unsigned char *) data;
+		for (size_t i=0;i<size;i++) {
+			hash ^= bytes[i];
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	/* Spread the bits of a hash, so the low bits used by the hash table depend on all of them */
+	static unsigned int mixHash(unsigned int hash) {
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6bu;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35u;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	PyValue::PyValue(PyObject *pValue, bool lazy) {
+
+		CDEBUG << "PvValue create: " << this << std::endl;
+		m_valueType = PyNullType;
+		setValue_FromPyObject(pValue,lazy);
+	}
+
+	PyValue::PyValue(const PyValue &value) {
+		CDEBUG << "PvValue create: " << this << std::endl;
+		m_valueType = PyNullType;
+		deepCopy(value);
+	}
+
+	PyValue::PyValue() {
+		CDEBUG << "PvValue create: " << this << std::endl;
+		m_valueType = PyNullType;
+		m_hash = 0;
+	}
+
+
+	PyValue::~PyValue() {
+		CDEBUG << "PvValue delete: " << this << std::endl;
+		valueRelease();
+	}
+
+	void PyValue::deepCopy(const PyValue &value) {
+		if (&value == this)
+			return;
+		valueRelease();
+		switch (value.valueType()) {
+		case PyLongType:
+			setValueAsLong(value.m_longVal);
+			break;
+		case PyDoubleType:
+			setValueAsDouble(value.m_doubleVal);
+			break;
+		case PyStringType:
+		case PyUnicodeType:
+			setString(value.stringData(),value.stringSize(),value.valueType());
+			break;
+		case PyTupleType:
+			shareTuple(value.m_tuple);
+			break;
+		case PyDictType:
+			shareDict(value.m_dict);
+			break;
+		default:
+			m_valueType = value.m_valueType;
+		}
+		m_hash = value.m_hash;
+	}
+
+	long PyValue::valueAsLong(bool *ok) const {
+		bool success = false;
+		if (m_valueType == PyLongType) {
+			success = true;
+		}
+		if (ok) {
+			*ok = success;
+		}
+		return success ? m_longVal : 0;
+	}
+
+	double PyValue::valueAsDouble(bool *ok) const {
+		bool success = false;
+		if (m_valueType == PyDoubleType) {
+			success = true;
+		}
+		if (ok) {
+			*ok = success;
+		}
+		return success ? m_doubleVal : 0.0;
+	}
+
+	/** \brief The string, or the UTF-8 text of a unicode string */
+	std::string PyValue::valueAsString(bool *ok) const {
+		bool success = false;
+		if (m_valueType == PyStringType || m_valueType == PyUnicodeType) {
+			success = true;
+		}
+		if (ok) {
+			*ok = success;
+		}
+		return success ? std::string(stringData(),stringSize()) : std::string();
+	}
+
+	const PyTuple &PyValue::valueAsTuple(bool *ok) const {
+		static const PyTuple emptyTuple;
+		bool success = false;
+		if (m_valueType == PyTupleType) {
+			success = true;
+		}
+		if (ok) {
+			*ok = success;
+		}
+		return success ? *m_tuple : emptyTuple;
+	}
+
+	const PyDict &PyValue::valueAsDict(bool *ok) const {
+		static const PyDict emptyDict;
+		bool success = false;
+		if (m_valueType == PyDictType) {
+			success = true;
+		}
+		if (ok) {
+			*ok = success;
+		}
+		return success ? *m_dict : emptyDict;
+	}
+
+	void PyValue::setValueAsLong(long value) {
+		valueRelease();
+		m_valueType = PyLongType;
+		m_longVal = value;
+	}
+
+	void PyValue::setValueAsDouble(double value) {
+		valueRelease();
+		m_valueType = PyDoubleType;
+		m_doubleVal = value;
+	}
+
+	void PyValue::setValueAsString(const std::string &value) {
+		setString(value.data(),value.size());
+	}
+
+	/** \brief Set a unicode string from UTF-8 text */
+	void PyValue::setValueAsUnicode(const std::string &value) {
+		setString(value.data(),value.size(),PyUnicodeType);
+	}
+
+	/** \brief Set a copy of the tuple, or share it if it is held by another value */
+	void PyValue::setValueAsTuple(const PyTuple &value) {
+		shareTuple(value.m_refs ? const_cast<PyTuple *>(&value) : new PyTuple(value));
+	}
+
+	/** \brief Set a copy of the dict, or share it if it is held by another value */
+	void PyValue::setValueAsDict(const PyDict &value) {
+		shareDict(value.m_refs ? const_cast<PyDict *>(&value) : new PyDict(value));
+	}
+
+	/* Hold a tuple, which is deleted with the last value holding it */
+	void PyValue::shareTuple(PyTuple *tuple) {
+		retain(tuple->m_refs);
+		valueRelease();
+		m_valueType = PyTupleType;
+		m_tuple = tuple;
+	}
+
+	void PyValue::shareDict(PyDict *dict) {
+		retain(dict->m_refs);
+		valueRelease();
+		m_valueType = PyDictType;
+		m_dict = dict;
+	}
+
+	/* Room for a string of size characters, inline if it fits, otherwise on the heap */
+	char *PyValue::newString(size_t size, ValueType valueType) {
+		valueRelease();
+		m_valueType = valueType;
+		if (size <= SmallStringSize) {
+			m_smallSize = size;
+			return m_smallString;
+		}
+		m_string = new std::string(size,'\0');
+		m_smallSize = largeString;
+		return &(*m_string)[0];
+	}
+
+	void PyValue::setString(const char *data, size_t size, ValueType valueType) {
+		memcpy(newString(size,valueType),data,size);
+	}
+
+	/* ASCII text is copied straight from the unicode object, other text is encoded by python */
+	void PyValue::setUnicode(PyObject *pValue) {
+		if (pyUnicodeCopyAscii(pValue,newString(PyUnicode_GET_SIZE(pValue),PyUnicodeType)))
+			return;
+		PyObject *pUtf8 = PyUnicode_AsUTF8String(pValue);
+		if (pUtf8) {
+			setString(PyString_AS_STRING(pUtf8),PyString_GET_SIZE(pUtf8),PyUnicodeType);
+			Py_DECREF(pUtf8);
+		}
+		else {
+			PyErr_Clear();
+			newString(0,PyUnicodeType);
+		}
+	}
+
+	const char *PyValue::stringData() const {
+		return m_smallSize == largeString ? m_string->data() : m_smallString;
+	}
+
+	size_t PyValue::stringSize() const {
+		return m_smallSize == largeString ? m_string->size() : m_smallSize;
+	}
+
+	/* Lists are converted to tuples. Lazy tuples and dicts keep the python object until they are read. */
+	void PyValue::setValue_FromPyObject(PyObject *pValue, bool lazy) {
+		valueRelease();
+		if (pValue) {
+			if (lazy && PyList_Check(pValue)) {
+				PyTuple *tuple = new PyTuple();
+				tuple->m_object = PyList_AsTuple(pValue);
+				tuple->m_lazy = true;
+				shareTuple(tuple);
+			}
+			else if (lazy && PyTuple_Check(pValue)) {
+				PyTuple *tuple = new PyTuple();
+				Py_INCREF(pValue);
+				tuple->m_object = pValue;
+				tuple->m_lazy = true;
+				shareTuple(tuple);
+			}
+			else if (lazy && PyDict_Check(pValue)) {
+				PyDict *dict = new PyDict();
+				Py_INCREF(pValue);
+				dict->m_object = pValue;
+				dict->m_lazy = true;
+				shareDict(dict);
+			}
+			else if (PyList_Check(pValue)) {
+				PyObject *pTuple = PyList_AsTuple(pValue);
+				shareTuple(new PyTuple(pTuple));
+				Py_XDECREF(pTuple);
+			}
+			else if (PyUnicode_Check(pValue)) {
+				setUnicode(pValue);
+			}
+			else if (PyFloat_Check(pValue)) {
+				m_doubleVal = PyFloat_AsDouble(pValue);
+				m_valueType = PyDoubleType;
+			}
+			else if (PyInt_Check(pValue)) {
+				m_longVal = PyInt_AsLong(pValue);
+				m_valueType = PyLongType;
+			}
+			else if (PyLong_Check(pValue)) {
+				m_longVal = PyLong_AsLong(pValue);
+				m_valueType = PyLongType;
+			}
+			else if (PyString_Check(pValue)) {
+				setString(PyString_AS_STRING(pValue),PyString_GET_SIZE(pValue));
+			}
+			else if (PyTuple_Check(pValue)) {
+				shareTuple(new PyTuple(pValue));
+			}
+			else if (PyDict_Check(pValue)) {
+				shareDict(new PyDict(pValue));
+			}
+		}
+	}
+
+	void PyValue::valueRelease() {
+		switch (m_valueType) {
+		case PyStringType:
+		case PyUnicodeType:
+			if (m_smallSize == largeString)
+				delete m_string;
+			break;
+		case PyTupleType:
+			if (release(m_tuple->m_refs))
+				delete m_tuple;
+			break;
+		case PyDictType:
+			if (release(m_dict->m_refs))
+				delete m_dict;
+			break;
+		}
+		m_valueType = PyNullType;
+		m_hash = 0;
+	}
+
+	std::string &replaceInStdString(std::string &s, const std::string &sub,const std::string &other) {
+		assert(!sub.empty());
+		size_t b = 0;
+		for (;;) {
+			b = s.find(sub, b);
+			if (b == s.npos) break;
+			s.replace(b, sub.size(), other);
+			b += other.size();
+		}
+		return s;
+	}
+
+	/** \brief Exchange the contents of two values without copying them.
+Use it to move a large result out of a PyResult or a PyValue owned by the session.
+*/
+	void PyValue::swap(PyValue &other) {
+		// The union is plain data as large as m_smallString, swapping its bytes moves any member
+		char data[SmallStringSize];
+		memcpy(data,m_smallString,SmallStringSize);
+		memcpy(m_smallString,other.m_smallString,SmallStringSize);
+		memcpy(other.m_smallString,data,SmallStringSize);
+		std::swap(m_valueType,other.m_valueType);
+		std::swap(m_smallSize,other.m_smallSize);
+		std::swap(m_hash,other.m_hash);
+	}
+
+	PyValue &PyValue::operator=(const PyValue &other) {
+		CDEBUG << "PvValue operator=: " << this << std::endl;
+		deepCopy(other);
+		return *this;
+	}
+
+	/** \brief Structural equality - the values have the same type and equal contents.
+Tuples are equal if their values are, dicts if they have equal keys with equal values.
+*/
+	bool PyValue::operator==(const PyValue &other) const {
+		if (m_valueType != other.m_valueType) {
+			return false;
+		}
+		if (m_hash && other.m_hash && m_hash != other.m_hash) {
+			return false;
+		}
+		switch (m_valueType) {
+		case PyLongType:
+			return m_longVal == other.m_longVal;
+		case PyDoubleType:
+			return m_doubleVal == other.m_doubleVal;
+		case PyStringType:
+		case PyUnicodeType:
+			return stringSize() == other.stringSize() && memcmp(stringData(),other.stringData(),stringSize()) == 0;
+		case PyTupleType:
+			return m_tuple == other.m_tuple || *m_tuple == *other.m_tuple;
+		case PyDictType:
+			return m_dict == other.m_dict || *m_dict == *other.m_dict;
+		}
+		return true;
+	}
+
+	/** \brief Hash of the contents, consistent with operator==().
+The hash is computed once and kept by the value until it changes.
+*/
+	unsigned int PyValue::hash() const {
+		if (m_hash) {
+			return m_hash;
+		}
+		unsigned int hash = hashBytes(&m_valueType,1,2166136261u);
+		switch (m_valueType) {
+		case PyLongType:
+			hash = hashBytes(&m_longVal,sizeof(m_longVal),hash);
+			break;
+		case PyDoubleType: {
+			double value = m_doubleVal == 0.0 ? 0.0 : m_doubleVal;	// -0.0 == 0.0
+			hash = hashBytes(&value,sizeof(value),hash);
+			break;
+		}
+		case PyStringType:
+		case PyUnicodeType:
+			// Unicode strings hash like strings, so string keys find them in a PyDict
+			m_hash = stringHash(stringData(),stringSize());
+			return m_hash;
+		case PyTupleType: {
+			PyTuple::const_iterator it_val = m_tuple->begin();
+			for (; it_val != m_tuple->end(); ++it_val) {
+				hash = (hash ^ it_val->hash()) * 16777619u;
+			}
+			break;
+		}
+		case PyDictType: {
+			// Equal dicts may hold their entries in different orders
+			unsigned int entries = 0;
+			PyDict::const_iterator it_val = m_dict->begin();
+			for (; it_val != m_dict->end(); ++it_val) {
+				entries += mixHash(it_val->key.hash()*31 + it_val->value.hash());
+			}
+			hash ^= entries;
+			break;
+		}
+		}
+		hash = mixHash(hash);
+		m_hash = hash ? hash : 1;
+		return m_hash;
+	}
+
+	/* Hash of a string, the same as hash() of a PyValue holding it */
+	unsigned int PyValue::stringHash(const char *data, size_t size) {
+		unsigned char valueType = PyStringType;
+		unsigned int hash = mixHash(hashBytes(data,size,hashBytes(&valueType,1,2166136261u)));
+		return hash ? hash : 1;
+	}
+
+	bool PyValue::operator<(const PyValue &other) const {
+		if (valueType()<other.valueType()) {
+			return true;
+		}
+		else if (valueType()>other.valueType()) {
+			return false;
+		}
+		else if (valueType()==PyLongType) {
+			return m_longVal<other.m_longVal;
+		}
+		else if (valueType()==PyDoubleType) {
+			return m_doubleVal<other.m_doubleVal;
+		}
+		else if (valueType()==PyStringType || valueType()==PyUnicodeType) {
+			size_t size = stringSize(), otherSize = other.stringSize();
+			int order = memcmp(stringData(),other.stringData(),size < otherSize ? size : otherSize);
+			return order < 0 || (order == 0 && size < otherSize);
+		}
+		return false;
+	}
+
+	std::string PyValue::str() const {
+		CDEBUG << "printing: " << this << std::endl;
+		std::ostringstream strstream;
+		if (valueType() == PyLongType) {
+			strstream << m_longVal;
+		}
+		if (valueType() == PyDoubleType) {
+			strstream << m_doubleVal;
+		}
+		if (valueType() == PyStringType || valueType() == PyUnicodeType) {
+			std::string tmp = valueAsString();
+			replaceInStdString(tmp,"\n","\\n");
+			strstream << (valueType() == PyUnicodeType ? "u'" : "'") << tmp << "'";
+		}
+		if (valueType() == PyTupleType) {
+			strstream << m_tuple->str();
+		}
+		if (valueType() == PyDictType) {
+			strstream << m_dict->str();
+		}
+		if (valueType() == PyNullType) {
+			strstream << "None";
+		}
+		return strstream.str();
+
+	}
+
+
+	/////////////////////////////
+	//  PyTuple
+	/////////////////////////////
+
+
+	PyTuple::PyTuple() {
+		CDEBUG << "PvTuple create: " << this << std::endl;
+		m_values = NULL;
+		m_size = 0;
+		m_capacity = 0;
+		m_refs = 0;
+		m_object = NULL;
+		m_lazy = false;
+	}
+
+	PyTuple::PyTuple(PyObject *pTuple) {
+		CDEBUG << "PvTuple create: " << this << std::endl;
+		m_values = NULL;
+		m_size = 0;
+		m_capacity = 0;
+		m_refs = 0;
+		m_object = NULL;
+		m_lazy = false;
+		if (!PyTuple_Check(pTuple)) {
+			return;
+		}
+		int size = PyTuple_GET_SIZE(pTuple);
+		reserve(size);
+		for (int i=0;i<size;i++) {
+			new (&m_values[i]) PyValue(PyTuple_GET_ITEM(pTuple,i));
+			m_size++;
+		}
+	}
+
+
+	PyTuple::PyTuple(const PyTuple &tuple) {
+		CDEBUG << "PyTuple create: " << this << std::endl;
+		m_values = NULL;
+		m_size = 0;
+		m_capacity = 0;
+		m_refs = 0;
+		m_object = NULL;
+		m_lazy = false;
+		deepCopy(tuple);
+	}
+
+	PyTuple &PyTuple::operator=(const PyTuple &other) {
+		CDEBUG << "PyTuple operator=: " << this << std::endl;
+		deepCopy(other);
+		return *this;
+	}
+
+	/* Tuples order by size, then by their first differing value */
+	bool PyTuple::operator<(const PyTuple &other) const {
+		convert();
+		other.convert();
+		if (size() < other.size()) {
+			return true;
+		}
+		else if (size() > other.size()) {
+			return false;
+		}
+		for (int i=0;i<m_size;i++) {
+			if (m_values[i] < other.m_values[i]) {
+				return true;
+			}
+			if (other.m_values[i] < m_values[i]) {
+				return false;
+			}
+		}
+		return false;
+	}
+
+	bool PyTuple::operator==(const PyTuple &other) const {
+		convert();
+		other.convert();
+		if (m_size != other.m_size) {
+			return false;
+		}
+		for (int i=0;i<m_size;i++) {
+			if (m_values[i] != other.m_values[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void PyTuple::deepCopy(const PyTuple &tuple) {
+		if (&tuple == this)
+			return;
+		clear();
+		tuple.convert();
+		reserve(tuple.m_size);
+		for (int i=0;i<tuple.m_size;i++) {
+			new (&m_values[i]) PyValue(tuple.m_values[i]);
+			m_size++;
+		}
+	}
+
+	/** \brief Exchange the values of two tuples without copying them */
+	void PyTuple::swap(PyTuple &other) {
+		convert();
+		other.convert();
+		swapValues(other);
+		std::swap(m_object,other.m_object);
+	}
+
+	/* Forget the python tuple, the values no longer match it */
+	void PyTuple::releaseObject() {
+		PyGILLock lock;
+		Py_DECREF(m_object);
+		m_object = NULL;
+	}
+
+	void PyTuple::swapValues(PyTuple &other) {
+		std::swap(m_values,other.m_values);
+		std::swap(m_size,other.m_size);
+		std::swap(m_capacity,other.m_capacity);
+	}
+
+	/* Convert the python tuple of a lazy tuple, its tuples and dicts stay lazy. Tuples held by
+	   values are shared by threads, so the conversion is done once under the GIL. */
+	void PyTuple::materialize() const {
+		PyGILLock lock;
+		if (!m_lazy) {
+			return;
+		}
+		PyTuple converted;
+		int size = PyTuple_GET_SIZE(m_object);
+		converted.reserve(size);
+		for (int i=0;i<size;i++) {
+			converted.addValue().setValue_FromPyObject(PyTuple_GET_ITEM(m_object,i),true);
+		}
+		PyTuple *tuple = const_cast<PyTuple *>(this);
+		tuple->swapValues(converted);
+		publish();
+		tuple->m_lazy = false;
+	}
+
+	PyTuple::~PyTuple() {
+		CDEBUG << "PvTuple delete: " << this << std::endl;
+		clear();
+		operator delete(m_values);
+	}
+
+	void PyTuple::clear() {
+		for (int i=0;i<m_size;i++) {
+			m_values[i].~PyValue();
+		}
+		m_size = 0;
+		if (m_object) {
+			releaseObject();
+		}
+		m_lazy = false;
+	}
+
+	/** \brief Make room for capacity values, so adding up to that many values doesn't move the
+existing ones.
+*/
+	void PyTuple::reserve(int capacity) {
+		convert();
+		if (capacity <= m_capacity) {
+			return;
+		}
+		// A PyValue holds no pointers into itself, so the values are moved by copying their bytes
+		PyValue *values = static_cast<PyValue *>(operator new(capacity*sizeof(PyValue)));
+		if (m_size) {
+			memcpy((void *) values,m_values,m_size*sizeof(PyValue));
+		}
+		operator delete(m_values);
+		m_values = values;
+		m_capacity = capacity;
+	}
+
+	PyValue* PyTuple::value(int index) {
+		modify();
+		if (index < 0 || index >= m_size) {
+			return NULL;
+		}
+		return &m_values[index];
+	}
+
+	const PyValue &PyTuple::value(int index) const {
+		convert();
+		if (index < 0 || index >= m_size) {
+			return pyNullValue;
+		}
+		return m_values[index];
+	}
+
+	void PyTuple::addValue(const PyValue &val) {
+		modify();
+		if (m_size == m_capacity && &val >= m_values && &val < m_values+m_size) {
+			// val is one of our values and would move
+			PyValue copy(val);
+			addValue().swap(copy);
+			return;
+		}
+		addValue().deepCopy(val);
+	}
+
+	/** \brief Append a None value and return it, to be set in place.
+Fx. tuple.addValue().setValueAsLong(42)
+*/
+	PyValue &PyTuple::addValue() {
+		modify();
+		if (m_size == m_capacity) {
+			reserve(m_capacity ? m_capacity*2 : 4);
+		}
+		PyValue *val = new (&m_values[m_size]) PyValue();
+		m_size++;
+		return *val;
+	}
+
+	void PyTuple::removeValue(int index) {
+		modify();
+		if (index < 0 || index >= m_size) {
+			return;
+		}
+		m_values[index].~PyValue();
+		if (index < m_size-1) {
+			memmove((void *) &m_values[index],&m_values[index+1],(m_size-index-1)*sizeof(PyValue));
+		}
+		m_size--;
+	}
+
+	std::string PyTuple::str() const {
+		convert();
+		std::ostringstream strstream;
+		strstream << '(';
+		for (int i=0;i<m_size;i++) {
+			if (i) {
+				strstream << ",";
+			}
+			strstream << m_values[i].str();
+		}
+		if (m_size==1) {
+			strstream << ",";
+		}
+		strstream << ')';
+		return strstream.str();
+	}
+
+
+
+	PyKey::PyKey(const PyValue &key) : m_key(key) {
+		m_key.hash();
+	}
+
+	PyKey::PyKey(const std::string &key) : m_key(key) {
+		m_key.hash();
+	}
+
+	PyKey::PyKey(const char *key) : m_key(std::string(key)) {
+		m_key.hash();
+	}
+
+	/* Entries of hash slots which are free, or were used by a removed entry */
+	static const int emptySlot = -1;
+	static const int removedSlot = -2;
+
+	PyDict::PyDict() {
+		m_entries = NULL;
+		m_size = 0;
+		m_capacity = 0;
+		m_index = NULL;
+		m_indexSize = 0;
+		m_removedSlots = 0;
+		m_refs = 0;
+		m_object = NULL;
+		m_lazy = false;
+	}
+
+	PyDict::PyDict(PyObject *pDict){
+		CDEBUG << "PyDict create: " << this << std::endl;
+		m_entries = NULL;
+		m_size = 0;
+		m_capacity = 0;
+		m_index = NULL;
+		m_indexSize = 0;
+		m_removedSlots = 0;
+		m_refs = 0;
+		m_object = NULL;
+		m_lazy = false;
+		if (!PyDict_Check(pDict)) {
+			return;
+		}
+		reserve(PyDict_Size(pDict));
+		PyObject *pKey, *pValue;
+		Py_ssize_t pos = 0;
+		while (PyDict_Next(pDict,&pos,&pKey,&pValue)) {
+			PyValue key(pKey);
+			insert(key).setValue_FromPyObject(pValue);
+		}
+	}
+
+	PyDict::PyDict(const PyDict &dict) {
+		m_entries = NULL;
+		m_size = 0;
+		m_capacity = 0;
+		m_index = NULL;
+		m_indexSize = 0;
+		m_removedSlots = 0;
+		m_refs = 0;
+		m_object = NULL;
+		m_lazy = false;
+		deepCopy(dict);
+	}
+
+	PyDict::~PyDict() {
+		clear();
+		operator delete(m_entries);
+		delete [] m_index;
+	}
+
+	PyDict &PyDict::operator=(const PyDict &other) {
+		CDEBUG << "PyDict operator=: " << this << std::endl;
+		deepCopy(other);
+		return *this;
+	}
+
+	/* Dicts are equal if they have the same keys with equal values, in any order */
+	bool PyDict::operator==(const PyDict &other) const {
+		convert();
+		other.convert();
+		if (m_size != other.m_size) {
+			return false;
+		}
+		for (int i=0;i<m_size;i++) {
+			int entry = other.find(m_entries[i].key);
+			if (entry < 0 || other.m_entries[entry].value != m_entries[i].value) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void PyDict::deepCopy(const PyDict &dict) {
+		if (&dict == this)
+			return;
+		clear();
+		dict.convert();
+		reserve(dict.m_size);
+		for (int i=0;i<dict.m_size;i++) {
+			insert(dict.m_entries[i].key).deepCopy(dict.m_entries[i].value);
+		}
+	}
+
+	/** \brief Exchange the entries of two dicts without copying them */
+	void PyDict::swap(PyDict &other) {
+		convert();
+		other.convert();
+		swapEntries(other);
+		std::swap(m_object,other.m_object);
+	}
+
+	void PyDict::releaseObject() {
+		PyGILLock lock;
+		Py_DECREF(m_object);
+		m_object = NULL;
+	}
+
+	void PyDict::swapEntries(PyDict &other) {
+		std::swap(m_entries,other.m_entries);
+		std::swap(m_size,other.m_size);
+		std::swap(m_capacity,other.m_capacity);
+		std::swap(m_index,other.m_index);
+		std::swap(m_indexSize,other.m_indexSize);
+		std::swap(m_removedSlots,other.m_removedSlots);
+	}
+
+	/* Convert the python dict of a lazy dict, like PyTuple::materialize() */
+	void PyDict::materialize() const {
+		PyGILLock lock;
+		if (!m_lazy) {
+			return;
+		}
+		PyDict converted;
+		converted.reserve(PyDict_Size(m_object));
+		PyObject *pKey, *pValue;
+		Py_ssize_t pos = 0;
+		while (PyDict_Next(m_object,&pos,&pKey,&pValue)) {
+			PyValue key(pKey);
+			converted.insert(key).setValue_FromPyObject(pValue,true);
+		}
+		PyDict *dict = const_cast<PyDict *>(this);
+		dict->swapEntries(converted);
+		publish();
+		dict->m_lazy = false;
+		// Dicts are not passed back to python, the python dict isn't needed any more
+		Py_DECREF(dict->m_object);
+		dict->m_object = NULL;
+	}
+
+	void PyDict::clear() {
+		for (int i=0;i<m_size;i++) {
+			m_entries[i].~PyDictEntry();
+		}
+		m_size = 0;
+		for (int i=0;i<m_indexSize;i++) {
+			m_index[i] = emptySlot;
+		}
+		m_removedSlots = 0;
+		if (m_object) {
+			releaseObject();
+		}
+		m_lazy = false;
+	}
+
+	/** \brief Make room for size entries, so adding up to that many doesn't grow the table */
+	void PyDict::reserve(int size) {
+		convert();
+		if (size > m_capacity) {
+			// A PyValue holds no pointers into itself, so the entries are moved by copying their bytes
+			PyDictEntry *entries = static_cast<PyDictEntry *>(operator new(size*sizeof(PyDictEntry)));
+			if (m_size) {
+				memcpy((void *) entries,m_entries,m_size*sizeof(PyDictEntry));
+			}
+			operator delete(m_entries);
+			m_entries = entries;
+			m_capacity = size;
+		}
+		// At most two thirds of the hash slots are used
+		int indexSize = 8;
+		while (indexSize*2 < size*3) {
+			indexSize *= 2;
+		}
+		if (indexSize > m_indexSize) {
+			rehash(indexSize);
+		}
+	}
+
+	/* Rebuild the hash slots */
+	void PyDict::rehash(int indexSize) {
+		delete [] m_index;
+		m_index = new int[indexSize];
+		m_indexSize = indexSize;
+		m_removedSlots = 0;
+		for (int i=0;i<indexSize;i++) {
+			m_index[i] = emptySlot;
+		}
+		unsigned int mask = indexSize-1;
+		for (int i=0;i<m_size;i++) {
+			unsigned int hash = m_entries[i].key.hash();
+			unsigned int slot = hash & mask;
+			for (unsigned int perturb = hash; m_index[slot] != emptySlot; perturb >>= 5) {
+				slot = (slot*5 + perturb + 1) & mask;
+			}
+			m_index[slot] = i;
+		}
+	}
+
+	/* The entry of key, or -1 */
+	int PyDict::find(const PyValue &key) const {
+		convert();
+		if (!m_indexSize) {
+			return -1;
+		}
+		unsigned int hash = key.hash();
+		unsigned int mask = m_indexSize-1;
+		unsigned int slot = hash & mask;
+		for (unsigned int perturb = hash; m_index[slot] != emptySlot; perturb >>= 5) {
+			int entry = m_index[slot];
+			if (entry >= 0 && m_entries[entry].key == key) {
+				return entry;
+			}
+			slot = (slot*5 + perturb + 1) & mask;
+		}
+		return -1;
+	}
+
+	/* The entry of a string or unicode key, or -1 */
+	int PyDict::find(const char *key, size_t size) const {
+		convert();
+		if (!m_indexSize) {
+			return -1;
+		}
+		unsigned int hash = PyValue::stringHash(key,size);
+		unsigned int mask = m_indexSize-1;
+		unsigned int slot = hash & mask;
+		for (unsigned int perturb = hash; m_index[slot] != emptySlot; perturb >>= 5) {
+			int entry = m_index[slot];
+			if (entry >= 0) {
+				const PyValue &candidate = m_entries[entry].key;
+				if ((candidate.m_valueType == PyValue::PyStringType || candidate.m_valueType == PyValue::PyUnicodeType)
+					&& candidate.hash() == hash
+					&& candidate.stringSize() == size && memcmp(candidate.stringData(),key,size) == 0) {
+					return entry;
+				}
+			}
+			slot = (slot*5 + perturb + 1) & mask;
+		}
+		return -1;
+	}
+
+	/* The value of key, added as None if the key is new */
+	PyValue &PyDict::insert(const PyValue &key) {
+		int entry = find(key);
+		if (entry >= 0) {
+			return m_entries[entry].value;
+		}
+		if ((m_size+m_removedSlots+1)*3 > m_indexSize*2) {
+			int indexSize = 8;
+			while (indexSize < (m_size+1)*3) {
+				indexSize *= 2;
+			}
+			rehash(indexSize);
+		}
+		if (m_size == m_capacity) {
+			reserve(m_capacity ? m_capacity*2 : 4);
+		}
+		PyDictEntry *newEntry = new (&m_entries[m_size]) PyDictEntry;
+		newEntry->key.deepCopy(key);
+
+		unsigned int hash = newEntry->key.hash();
+		unsigned int mask = m_indexSize-1;
+		unsigned int slot = hash & mask;
+		for (unsigned int perturb = hash; m_index[slot] >= 0; perturb >>= 5) {
+			slot = (slot*5 + perturb + 1) & mask;
+		}
+		if (m_index[slot] == removedSlot) {
+			m_removedSlots--;
+		}
+		m_index[slot] = m_size;
+		m_size++;
+		return newEntry->value;
+	}
+
+	PyValue *PyDict::value(const PyValue &key) {
+		modify();
+		int entry = find(key);
+		if (entry >= 0) {
+			return &m_entries[entry].value;
+		}
+		return NULL;
+	}
+
+	PyValue *PyDict::value(const PyKey &key) {
+		return value(key.key());
+	}
+
+	PyValue *PyDict::value(const std::string &key) {
+		modify();
+		int entry = find(key.data(),key.size());
+		if (entry >= 0) {
+			return &m_entries[entry].value;
+		}
+		return NULL;
+	}
+
+	PyValue *PyDict::value(const char *key) {
+		modify();
+		int entry = find(key,strlen(key));
+		if (entry >= 0) {
+			return &m_entries[entry].value;
+		}
+		return NULL;
+	}
+
+	const PyValue &PyDict::value(const PyValue &key) const {
+		int entry = find(key);
+		if (entry >= 0) {
+			return m_entries[entry].value;
+		}
+		return pyNullValue;
+	}
+
+	const PyValue &PyDict::value(const PyKey &key) const {
+		return value(key.key());
+	}
+
+	const PyValue &PyDict::value(const std::string &key) const {
+		int entry = find(key.data(),key.size());
+		if (entry >= 0) {
+			return m_entries[entry].value;
+		}
+		return pyNullValue;
+	}
+
+	const PyValue &PyDict::value(const char *key) const {
+		int entry = find(key,strlen(key));
+		if (entry >= 0) {
+			return m_entries[entry].value;
+		}
+		return pyNullValue;
+	}
+
+	void PyDict::setValue(const PyValue &key, const PyValue &val) {
+		modify();
+		const char *address = reinterpret_cast<const char *>(&val);
+		if (m_size && address >= reinterpret_cast<const char *>(m_entries) && address < reinterpret_cast<const char *>(m_entries+m_size)) {
+			// val is one of our values and may move
+			PyValue copy(val);
+			insert(key).swap(copy);
+			return;
+		}
+		insert(key).deepCopy(val);
+	}
+
+	void PyDict::removeValue(const PyValue &key) {
+		modify();
+		int entry = find(key);
+		if (entry < 0) {
+			return;
+		}
+		m_entries[entry].~PyDictEntry();
+		if (entry < m_size-1) {
+			memmove((void *) &m_entries[entry],&m_entries[entry+1],(m_size-entry-1)*sizeof(PyDictEntry));
+		}
+		m_size--;
+		// Slots keep probing past the removed entry, later entries moved down by one
+		for (int i=0;i<m_indexSize;i++) {
+			if (m_index[i] == entry) {
+				m_index[i] = removedSlot;
+				m_removedSlots++;
+			}
+			else if (m_index[i] > entry) {
+				m_index[i]--;
+			}
+		}
+	}
+
+	std::string PyDict::str() const {
+		convert();
+		std::ostringstream strstream;
+		strstream << '{';
+		for (int i=0;i<m_size;i++) {
+			if (i) {
+				strstream << ",";
+			}
+			strstream << m_entries[i].key.str() << ":" << m_entries[i].value.str();
+		}
+		strstream << '}';
+		return strstream.str();
+	}
+}
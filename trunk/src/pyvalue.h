@@ -1,111 +1,263 @@
-#ifndef PYVALUE_H
-#define PYVALUE_H
-
-#include "pyembdef.h"
-
-#include <vector>
-#include <map>
-#include <string>
-
-#pragma warning( disable: 4251 )
-
-struct _object;
-typedef _object PyObject;
-
-namespace PyEmb {
-	class PyClass;
-	class PyTuple;
-	class PyDict;
-
-	class PYEMB_DECLSPEC PyValue {
-
-	public:
-		enum ValueType {PyNullType,PyLongType,PyDoubleType,PyStringType,PyUnicodeType,PyTupleType,PyDictType};
-
-		PyValue(PyObject *pValue);
-		PyValue();
-		PyValue(long value) {m_tuple = NULL;m_dict = NULL;setValueAsLong(value);}
-		PyValue(double value) {m_tuple = NULL;m_dict = NULL;setValueAsDouble(value);}
-		PyValue(const std::string &value) {m_tuple = NULL;m_dict = NULL;setValueAsString(value);}
-		PyValue(const PyTuple &value) {m_tuple = NULL;m_dict = NULL;setValueAsTuple(value);}
-		PyValue(const PyDict &value) {m_tuple = NULL;m_dict = NULL;setValueAsDict(value);}
-		PyValue(const PyValue &value);
-		~PyValue();
-		bool operator<(const PyValue &other) const;
-		PyValue &operator=(const PyValue &other);
-		void deepCopy(const PyValue &value);
-		long valueAsLong(bool *ok=NULL) const;
-		double valueAsDouble(bool *ok=NULL) const;
-		const std::string &valueAsString(bool *ok=NULL) const;
-		const PyTuple &valueAsTuple(bool *ok=NULL) const;
-		const PyDict &valueAsDict(bool *ok=NULL) const;
-		ValueType valueType() const {return m_valueType;}
-		void setValueAsLong(long value);
-		void setValueAsDouble(double value);
-		void setValueAsString(const std::string &value);
-		void setValueAsTuple(const PyTuple &value);
-		void setValueAsDict(const PyDict &value);
-		std::string str() const;
-		static PyValue *buildPyValue(const char * Format,...);
-
-	private:
-		void valueRelease();
-		void setValue_FromPyObject(PyObject *pValue);
-		long m_longVal;
-		std::string m_stringVal;
-		double m_doubleVal;
-		PyTuple *m_tuple;
-		PyDict *m_dict;
-		ValueType m_valueType;
-	};
-
-
-	typedef std::vector<PyValue*> PyValueArray;
-
-	class PYEMB_DECLSPEC PyTuple {
-
-	public:
-		PyTuple();
-		PyTuple(PyObject *pTuple);
-		PyTuple(const PyTuple &tuple);
-		~PyTuple();
-		bool operator<(const PyTuple &tuple) const;
-		PyTuple &operator=(const PyTuple &tuple);
-		void deepCopy(const PyTuple &tuple);
-		PyValue *value(int index);
-		const PyValue &value(int index) const;
-		void addValue(const PyValue &val);
-		void removeValue(int index);
-		int size() const {return m_valueArray.size();}
-		std::string str() const;
-
-	private:
-		PyValueArray m_valueArray;
-	};
-
-
-	typedef std::map<PyValue,PyValue *> PyValueMap;
-
-	class PYEMB_DECLSPEC PyDict {
-
-	public:
-		PyDict();
-		PyDict(PyObject *pDict);
-		PyDict(const PyDict &dict);
-		~PyDict();
-		PyDict &operator=(const PyDict &tuple);
-		void deepCopy(const PyDict &dict);
-		PyValue *value(const PyValue &key);
-		const PyValue &value(const PyValue &key) const;
-		void setValue(const PyValue &key, const PyValue &val);
-		void removeValue(const PyValue &key);
-		int size() {return m_valueMap.size();}
-		std::string str() const;
-
-	private:
-		PyValueMap m_valueMap;
-	};
-
-}
-
-#endif
+#ifndef PYVALUE_H
+#define PYVALUE_H
+
+#include "pyembdef.h"
+
+#include <vector>
+#include <map>
+#include <string>
+
+#pragma warning( disable: 4251 )
+
+struct _object;
+typedef _object PyObject;
+
+namespace PyEmb {
+	class PyClass;
+	class PyTuple;
+	class PyDict;
+	class PyKey;
+	class PyValueCodec;
+
+	/** \class PyValue
+ A PyValue holds a copy of a python value - None, an integer, a float, a string, a unicode string, a tuple
+ or a dict. Only the contents of the current type are stored: integers, floats and strings of up to
+ SmallStringSize characters are kept inside the value, longer strings, tuples and dicts on the heap.
+ Unicode strings are stored as UTF-8 and returned by valueAsString() like strings.
+ <br><br>
+ The tuple or dict of a value is immutable and shared by reference count, so copying a value costs the
+ same whatever it holds. To change part of it, copy the tuple or dict out with valueAsTuple() or
+ valueAsDict(), which copies one level, modify the copy and set it back - only the changed path is cloned.
+ <br><br>
+ PASS-THROUGH <br>
+ Lazily converted tuples keep the python tuple they came from. PySession::pyValueToPyObject() hands that
+ tuple back instead of building a new one, so passing a result on to another call costs nothing. The tuple
+ still holds the python objects it was converted from, so a dict or list in it which python has changed
+ since is passed on as changed. Lists are passed back as the tuple they were converted to, dicts are
+ always built anew. A standalone PyTuple forgets its python tuple when it is modified. Eagerly converted
+ values hold no python objects and may outlive the PySession.
+ <br><br>
+ LAZY CONVERSION <br>
+ A value constructed with lazy set keeps a reference to the python tuples, lists and dicts it holds, and
+ converts each of them one level at a time when it is first read. Reading one field of a large result only
+ converts the containers on the path to it. The python objects must not be modified while the value holds
+ them, and a lazy value must be released before the PySession, see PySession::setLazyConversionEnabled().
+*/
+	class PYEMB_DECLSPEC PyValue {
+		friend class PySession;
+		friend class PyValueCodec;
+		friend class PyTuple;
+		friend class PyDict;
+		template<class T> friend struct PyValueSetter;
+
+	public:
+		enum ValueType {PyNullType,PyLongType,PyDoubleType,PyStringType,PyUnicodeType,PyTupleType,PyDictType};
+
+		PyValue(PyObject *pValue, bool lazy=false);
+		PyValue();
+		PyValue(long value) {m_valueType = PyNullType;setValueAsLong(value);}
+		PyValue(double value) {m_valueType = PyNullType;setValueAsDouble(value);}
+		PyValue(const std::string &value) {m_valueType = PyNullType;setValueAsString(value);}
+		PyValue(const PyTuple &value) {m_valueType = PyNullType;setValueAsTuple(value);}
+		PyValue(const PyDict &value) {m_valueType = PyNullType;setValueAsDict(value);}
+		PyValue(const PyValue &value);
+		~PyValue();
+		bool operator<(const PyValue &other) const;
+		bool operator==(const PyValue &other) const;
+		bool operator!=(const PyValue &other) const {return !(*this == other);}
+		unsigned int hash() const;
+		PyValue &operator=(const PyValue &other);
+		void deepCopy(const PyValue &value);
+		void swap(PyValue &other);
+		long valueAsLong(bool *ok=NULL) const;
+		double valueAsDouble(bool *ok=NULL) const;
+		std::string valueAsString(bool *ok=NULL) const;
+		const PyTuple &valueAsTuple(bool *ok=NULL) const;
+		const PyDict &valueAsDict(bool *ok=NULL) const;
+		ValueType valueType() const {return (ValueType) m_valueType;}
+		void setValueAsLong(long value);
+		void setValueAsDouble(double value);
+		void setValueAsString(const std::string &value);
+		void setValueAsUnicode(const std::string &value);
+		void setValueAsTuple(const PyTuple &value);
+		void setValueAsDict(const PyDict &value);
+		std::string str() const;
+		static PyValue *buildPyValue(const char * Format,...);
+
+		enum {SmallStringSize = sizeof(double)};
+
+	private:
+		void valueRelease();
+		void setValue_FromPyObject(PyObject *pValue, bool lazy=false);
+		char *newString(size_t size, ValueType valueType);
+		void setString(const char *data, size_t size, ValueType valueType=PyStringType);
+		void setUnicode(PyObject *pValue);
+		const char *stringData() const;
+		size_t stringSize() const;
+		static unsigned int stringHash(const char *data, size_t size);
+		void shareTuple(PyTuple *tuple);
+		void shareDict(PyDict *dict);
+
+		// Only the member of the current type is valid
+		union {
+			long m_longVal;
+			double m_doubleVal;
+			char m_smallString[SmallStringSize];
+			std::string *m_string;
+			PyTuple *m_tuple;
+			PyDict *m_dict;
+		};
+		unsigned char m_valueType;
+		unsigned char m_smallSize;	// size of a string or unicode string in m_smallString, 0xff if it is in m_string
+		mutable unsigned int m_hash;	// 0 until hash() is called
+	};
+
+
+	typedef std::vector<PyValue*> PyValueArray;
+
+	/** \class PyTuple
+ A PyTuple stores its values next to each other in one buffer, so value() is O(1) and the values can
+ be visited with begin() and end() like a std::vector. Pointers and iterators to the values are
+ invalidated when values are added beyond the capacity, see reserve(), or removed.
+*/
+	class PYEMB_DECLSPEC PyTuple {
+		friend class PyValue;
+		friend class PyValueCodec;
+		friend class PySession;
+
+	public:
+		typedef PyValue *iterator;
+		typedef const PyValue *const_iterator;
+
+		PyTuple();
+		PyTuple(PyObject *pTuple);
+		PyTuple(const PyTuple &tuple);
+		~PyTuple();
+		bool operator<(const PyTuple &tuple) const;
+		bool operator==(const PyTuple &tuple) const;
+		PyTuple &operator=(const PyTuple &tuple);
+		void deepCopy(const PyTuple &tuple);
+		void swap(PyTuple &other);
+		PyValue *value(int index);
+		const PyValue &value(int index) const;
+		void addValue(const PyValue &val);
+		PyValue &addValue();
+		void removeValue(int index);
+		void reserve(int capacity);
+		int size() const {convert();return m_size;}
+		int capacity() const {convert();return m_capacity;}
+		iterator begin() {modify();return m_values;}
+		iterator end() {modify();return m_values+m_size;}
+		const_iterator begin() const {convert();return m_values;}
+		const_iterator end() const {convert();return m_values+m_size;}
+		std::string str() const;
+
+	private:
+		void clear();
+		void convert() const {if (m_lazy) materialize();}
+		void modify() {convert();if (m_object) releaseObject();}
+		void materialize() const;
+		void releaseObject();
+		void swapValues(PyTuple &other);
+
+		PyValue *m_values;
+		int m_size;
+		int m_capacity;
+		volatile long m_refs;	// values sharing the tuple, 0 if it is not held by a value
+		PyObject *m_object;		// python tuple of a lazy tuple
+		volatile bool m_lazy;	// m_object is not converted yet
+	};
+
+
+	/** \class PyKey
+ A dict key with its hash computed up front, for looking up the same key in many dicts.
+ A const PyKey may be shared by threads, since looking it up never writes to it.
+*/
+	class PYEMB_DECLSPEC PyKey {
+	public:
+		PyKey(const PyValue &key);
+		PyKey(const std::string &key);
+		PyKey(const char *key);
+		const PyValue &key() const {return m_key;}
+		unsigned int hash() const {return m_key.hash();}
+
+	private:
+		PyValue m_key;
+	};
+
+
+	/** \struct PyDictEntry
+ A key and its value in a PyDict
+*/
+	struct PYEMB_DECLSPEC PyDictEntry {
+		PyValue key;
+		PyValue value;
+	};
+
+	/** \class PyDict
+ A PyDict is a hash table of PyValue keys and values, using PyValue::hash() and PyValue::operator==().
+ Keys of different types are different keys, so 1 and 1.0 are two keys. The entries are stored and
+ iterated in the order they were added. Removing an entry moves the entries after it.
+ <br><br>
+ String keys may be looked up as std::string or C string, which hashes and compares the characters
+ without building a PyValue, and also finds unicode keys with that UTF-8 text. A PyKey is hashed once
+ for any number of lookups.
+*/
+	class PYEMB_DECLSPEC PyDict {
+		friend class PyValue;
+		friend class PyValueCodec;
+		friend class PySession;
+
+	public:
+		typedef const PyDictEntry *const_iterator;
+
+		PyDict();
+		PyDict(PyObject *pDict);
+		PyDict(const PyDict &dict);
+		~PyDict();
+		PyDict &operator=(const PyDict &tuple);
+		bool operator==(const PyDict &other) const;
+		void deepCopy(const PyDict &dict);
+		void swap(PyDict &other);
+		PyValue *value(const PyValue &key);
+		PyValue *value(const PyKey &key);
+		PyValue *value(const std::string &key);
+		PyValue *value(const char *key);
+		const PyValue &value(const PyValue &key) const;
+		const PyValue &value(const PyKey &key) const;
+		const PyValue &value(const std::string &key) const;
+		const PyValue &value(const char *key) const;
+		void setValue(const PyValue &key, const PyValue &val);
+		void removeValue(const PyValue &key);
+		void reserve(int size);
+		int size() const {convert();return m_size;}
+		const_iterator begin() const {convert();return m_entries;}
+		const_iterator end() const {convert();return m_entries+m_size;}
+		std::string str() const;
+
+	private:
+		void clear();
+		void convert() const {if (m_lazy) materialize();}
+		void modify() {convert();if (m_object) releaseObject();}
+		void materialize() const;
+		void releaseObject();
+		void swapEntries(PyDict &other);
+		int find(const PyValue &key) const;
+		int find(const char *key, size_t size) const;
+		PyValue &insert(const PyValue &key);
+		void rehash(int indexSize);
+
+		PyDictEntry *m_entries;		// in the order they were added
+		int m_size;
+		int m_capacity;
+		int *m_index;				// entry of each hash slot, emptySlot or removedSlot
+		int m_indexSize;			// a power of two
+		int m_removedSlots;
+		volatile long m_refs;	// values sharing the dict, 0 if it is not held by a value
+		PyObject *m_object;		// python dict of a lazy dict
+		volatile bool m_lazy;	// m_object is not converted yet
+	};
+
+}
+
+#endif
@@ -0,0 +1,293 @@
+#include <Python.h>
+#include "pyvaluecodec.h"
+#include "pyunicode.h"
+
+#include <cstring>
+
+namespace PyEmb {
+	/* Type tags of the encoding */
+	enum {
+		CodecNull = 'N',
+		CodecLong = 'L',
+		CodecDouble = 'D',
+		CodecString = 'S',
+		CodecUnicode = 'U',
+		CodecTuple = 'T',
+		CodecDict = 'M'
+	};
+
+	template <class T> static void encodeRaw(T value, std::string &out) {
+		out.append((const char *) &value,sizeof(T));
+	}
+
+	template <class T> static bool decodeRaw(const char *&pos, const char *end, T &value) {
+		if (end-pos < (int) sizeof(T))
+			return false;
+		memcpy(&value,pos,sizeof(T));
+		pos += sizeof(T);
+		return true;
+	}
+
+	void PyValueCodec::encodeSize(size_t size, std::string &out) {
+		encodeRaw<unsigned int>(size,out);
+	}
+
+	bool PyValueCodec::decodeSize(const char *&pos, const char *end, size_t &size) {
+		unsigned int value;
+		if (!decodeRaw(pos,end,value))
+			return false;
+		size = value;
+		return true;
+	}
+
+	void PyValueCodec::encodeString(const std::string &value, std::string &out) {
+		encodeSize(value.size(),out);
+		out.append(value);
+	}
+
+	bool PyValueCodec::decodeString(const char *&pos, const char *end, std::string &value) {
+		size_t size;
+		if (!decodeSize(pos,end,size) || (size_t) (end-pos) < size)
+			return false;
+		value.assign(pos,size);
+		pos += size;
+		return true;
+	}
+
+	/* Encode a PyValue. Unicode strings are encoded as their UTF-8 text */
+	void PyValueCodec::encode(const PyValue &value, std::string &out) {
+		switch (value.valueType()) {
+		case PyValue::PyLongType:
+			out += (char) CodecLong;
+			encodeRaw(value.valueAsLong(),out);
+			break;
+		case PyValue::PyDoubleType:
+			out += (char) CodecDouble;
+			encodeRaw(value.valueAsDouble(),out);
+			break;
+		case PyValue::PyStringType:
+		case PyValue::PyUnicodeType:
+			out += (char) (value.valueType() == PyValue::PyStringType ? CodecString : CodecUnicode);
+			encodeSize(value.stringSize(),out);
+			out.append(value.stringData(),value.stringSize());
+			break;
+		case PyValue::PyTupleType: {
+			const PyTuple &tuple = value.valueAsTuple();
+			out += (char) CodecTuple;
+			encodeSize(tuple.size(),out);
+			PyTuple::const_iterator it_val = tuple.begin();
+			for (; it_val != tuple.end(); ++it_val) {
+				encode(*it_val,out);
+			}
+			break;
+		}
+		case PyValue::PyDictType: {
+			const PyDict &dict = value.valueAsDict();
+			out += (char) CodecDict;
+			encodeSize(dict.size(),out);
+			PyDict::const_iterator it_val = dict.begin();
+			for (; it_val != dict.end(); ++it_val) {
+				encode(it_val->key,out);
+				encode(it_val->value,out);
+			}
+			break;
+		}
+		default:
+			out += (char) CodecNull;
+		}
+	}
+
+	/* Encode a python object the way PyValue(PyObject*) converts it, lists as tuples.
+	   Returns false if python raised an exception while reading the object */
+	bool PyValueCodec::encode(PyObject *object, std::string &out) {
+		if (!object) {
+			out += (char) CodecNull;
+		}
+		else if (PyList_Check(object) || PyTuple_Check(object)) {
+			Py_ssize_t size = PySequence_Fast_GET_SIZE(object);
+			PyObject **items = PySequence_Fast_ITEMS(object);
+			out += (char) CodecTuple;
+			encodeSize(size,out);
+			for (Py_ssize_t i=0;i<size;i++) {
+				if (!encode(items[i],out))
+					return false;
+			}
+		}
+		else if (PyUnicode_Check(object)) {
+			std::string utf8;
+			pyUnicodeToUtf8(object,utf8);
+			out += (char) CodecUnicode;
+			encodeString(utf8,out);
+		}
+		else if (PyFloat_Check(object)) {
+			out += (char) CodecDouble;
+			encodeRaw(PyFloat_AsDouble(object),out);
+		}
+		else if (PyInt_Check(object)) {
+			out += (char) CodecLong;
+			encodeRaw(PyInt_AsLong(object),out);
+		}
+		else if (PyLong_Check(object)) {
+			long value = PyLong_AsLong(object);
+			if (value == -1 && PyErr_Occurred())
+				return false;
+			out += (char) CodecLong;
+			encodeRaw(value,out);
+		}
+		else if (PyString_Check(object)) {
+			out += (char) CodecString;
+			encodeSize(PyString_GET_SIZE(object),out);
+			out.append(PyString_AS_STRING(object),PyString_GET_SIZE(object));
+		}
+		else if (PyDict_Check(object)) {
+			PyObject *key, *value;
+			Py_ssize_t pos = 0;
+			out += (char) CodecDict;
+			encodeSize(PyDict_Size(object),out);
+			while (PyDict_Next(object,&pos,&key,&value)) {
+				if (!encode(key,out) || !encode(value,out))
+					return false;
+			}
+		}
+		else {
+			out += (char) CodecNull;
+		}
+		return true;
+	}
+
+	bool PyValueCodec::decode(const char *&pos, const char *end, PyValue &value) {
+		if (pos >= end)
+			return false;
+		char tag = *pos++;
+		switch (tag) {
+		case CodecNull:
+			value.valueRelease();
+			return true;
+		case CodecLong: {
+			long longVal;
+			if (!decodeRaw(pos,end,longVal))
+				return false;
+			value.setValueAsLong(longVal);
+			return true;
+		}
+		case CodecDouble: {
+			double doubleVal;
+			if (!decodeRaw(pos,end,doubleVal))
+				return false;
+			value.setValueAsDouble(doubleVal);
+			return true;
+		}
+		case CodecString:
+		case CodecUnicode: {
+			size_t size;
+			if (!decodeSize(pos,end,size) || (size_t) (end-pos) < size)
+				return false;
+			value.setString(pos,size,tag == CodecString ? PyValue::PyStringType : PyValue::PyUnicodeType);
+			pos += size;
+			return true;
+		}
+		case CodecTuple: {
+			size_t size;
+			if (!decodeSize(pos,end,size))
+				return false;
+			value.shareTuple(new PyTuple());
+			value.m_tuple->reserve(size);
+			for (size_t i=0;i<size;i++) {
+				if (!decode(pos,end,value.m_tuple->addValue()))
+					return false;
+			}
+			return true;
+		}
+		case CodecDict: {
+			size_t size;
+			if (!decodeSize(pos,end,size))
+				return false;
+			value.shareDict(new PyDict());
+			value.m_dict->reserve((int) size);
+			for (size_t i=0;i<size;i++) {
+				PyValue key;
+				if (!decode(pos,end,key) || !decode(pos,end,value.m_dict->insert(key))) {
+					return false;
+				}
+			}
+			return true;
+		}
+		}
+		return false;
+	}
+
+	/* Decode into a new python object. Returns NULL if the data is malformed */
+	PyObject *PyValueCodec::decode(const char *&pos, const char *end) {
+		if (pos >= end)
+			return NULL;
+		char tag = *pos++;
+		switch (tag) {
+		case CodecNull:
+			Py_INCREF(Py_None);
+			return Py_None;
+		case CodecLong: {
+			long longVal;
+			if (!decodeRaw(pos,end,longVal))
+				return NULL;
+			return PyLong_FromLong(longVal);
+		}
+		case CodecDouble: {
+			double doubleVal;
+			if (!decodeRaw(pos,end,doubleVal))
+				return NULL;
+			return PyFloat_FromDouble(doubleVal);
+		}
+		case CodecString: {
+			size_t size;
+			if (!decodeSize(pos,end,size) || (size_t) (end-pos) < size)
+				return NULL;
+			PyObject *string = PyString_FromStringAndSize(pos,size);
+			pos += size;
+			return string;
+		}
+		case CodecUnicode: {
+			size_t size;
+			if (!decodeSize(pos,end,size) || (size_t) (end-pos) < size)
+				return NULL;
+			PyObject *unicode = pyUnicodeFromUtf8(pos,size);
+			pos += size;
+			return unicode;
+		}
+		case CodecTuple: {
+			size_t size;
+			if (!decodeSize(pos,end,size))
+				return NULL;
+			PyObject *tuple = PyTuple_New(size);
+			for (size_t i=0;tuple && i<size;i++) {
+				PyObject *item = decode(pos,end);
+				if (!item) {
+					Py_DECREF(tuple);
+					return NULL;
+				}
+				PyTuple_SET_ITEM(tuple,i,item);
+			}
+			return tuple;
+		}
+		case CodecDict: {
+			size_t size;
+			if (!decodeSize(pos,end,size))
+				return NULL;
+			PyObject *dict = PyDict_New();
+			for (size_t i=0;dict && i<size;i++) {
+				PyObject *key = decode(pos,end);
+				PyObject *item = key ? decode(pos,end) : NULL;
+				if (!item || PyDict_SetItem(dict,key,item) < 0) {
+					Py_XDECREF(key);
+					Py_XDECREF(item);
+					Py_DECREF(dict);
+					return NULL;
+				}
+				Py_DECREF(key);
+				Py_DECREF(item);
+			}
+			return dict;
+		}
+		}
+		return NULL;
+	}
+}
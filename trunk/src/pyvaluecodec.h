@@ -0,0 +1,31 @@
+#ifndef PYVALUECODEC_H
+#define PYVALUECODEC_H
+
+#include "pyvalue.h"
+
+#include <string>
+
+struct _object;
+typedef _object PyObject;
+
+namespace PyEmb {
+	/* Binary encoding of PyValue trees used to pass values between processes. Values are
+	   encoded from PyValue or PyObject and decoded into either, so a process holding the
+	   python side never builds an intermediate PyValue. Both ends must run the same build */
+	class PyValueCodec {
+
+	public:
+		static void encode(const PyValue &value, std::string &out);
+		static bool encode(PyObject *object, std::string &out);
+		static bool decode(const char *&pos, const char *end, PyValue &value);
+		static PyObject *decode(const char *&pos, const char *end);
+		static void encodeString(const std::string &value, std::string &out);
+		static bool decodeString(const char *&pos, const char *end, std::string &value);
+
+	private:
+		static void encodeSize(size_t size, std::string &out);
+		static bool decodeSize(const char *&pos, const char *end, size_t &size);
+	};
+}
+
+#endif